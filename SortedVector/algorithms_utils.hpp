@@ -4,14 +4,204 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <utility>
 #include <set>
+#include <vector>
+#include <array>
+#include <future>
+#include <thread>
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+#include <string>
+#include <cassert>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#include <intrin.h>
+#endif
+
+
+// tag for overloads which may rely on the input range being already sorted
+struct sorted_range_t { explicit sorted_range_t() = default; };
+inline constexpr sorted_range_t sorted_range{};
+
+// removes overloads taking ranges from overload resolution for types which are not iterators
+template<class It>
+using enable_if_iterator = std::void_t<typename std::iterator_traits<It>::iterator_category>;
+
+template<class T>
+inline void prefetch(const T* ptr)
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	_mm_prefetch(reinterpret_cast<const char*>(ptr), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(ptr);
+#else
+	(void)ptr;
+#endif
+}
+
+
+inline int count_trailing_zeros(std::uint64_t bits)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index = 0;
+	_BitScanForward64(&index, bits);
+	return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(bits);
+#else
+	int index = 0;
+	for (; (bits & 1) == 0; bits >>= 1) { ++index; }
+	return index;
+#endif
+}
+
+// calls f(chunkFirst, chunkLast) for every of threadsCount chunks of [0, count) concurrently
+template<class F>
+void parallel_chunks(std::size_t count, std::size_t threadsCount, F f)
+{
+	threadsCount = std::max<std::size_t>(1, std::min(threadsCount, count));
+	const std::size_t chunkSize = (count + threadsCount - 1) / std::max<std::size_t>(1, threadsCount);
+
+	std::vector<std::future<void>> tasks;
+	for (std::size_t chunkFirst = chunkSize; chunkFirst < count; chunkFirst += chunkSize) {
+		tasks.push_back(std::async(std::launch::async, f, chunkFirst, std::min(chunkFirst + chunkSize, count)));
+	}
+
+	f(std::size_t{ 0 }, std::min(chunkSize, count));
+	for (auto& task : tasks) {
+		task.get();
+	}
+}
+
+namespace impl {
+
+	// elements not greater than this size are searched by branchless kernels
+	constexpr std::size_t branchless_search_max_size = 2 * sizeof(void*);
+
+	// count of remaining elements scanned linearly at the end of branchless search
+	constexpr std::ptrdiff_t linear_search_threshold = 8;
+
+	template<class It>
+	constexpr bool use_branchless_search_v =
+		std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category> &&
+		sizeof(typename std::iterator_traits<It>::value_type) <= branchless_search_max_size;
+
+	// first element for which pred is false, pred must partition [first, last)
+	template<class RandomIt, class Pred>
+	RandomIt branchless_partition_point(RandomIt first, RandomIt last, Pred pred)
+	{
+		auto len = last - first;
+		while (len > linear_search_threshold) {
+			const auto half = len / 2;
+			first = pred(first[half]) ? first + half : first;
+			len -= half;
+		}
+
+		for (last = first + len; first != last && pred(*first); ) {
+			++first;
+		}
+		return first;
+	}
+
+	template<class RandomIt, class Pred>
+	RandomIt gallop_partition_point(RandomIt hint, RandomIt last, Pred pred)
+	{
+		if (hint == last || !pred(*hint)) {
+			return hint;
+		}
+
+		typename std::iterator_traits<RandomIt>::difference_type step = 1;
+		while (step < (last - hint) && pred(hint[step])) {
+			hint += step;
+			step *= 2;
+		}
+
+		return branchless_partition_point(std::next(hint), (step < (last - hint)) ? hint + step : last, pred);
+	}
+}
+
+// lower/upper bound without data dependent branches (except of bounded linear tail)
+template<class RandomIt, class T, class Compare = std::less<>>
+RandomIt branchless_lower_bound(RandomIt first, RandomIt last, const T& value, Compare comp = {})
+{
+	return impl::branchless_partition_point(first, last, [&value, &comp](const auto& elem) { return comp(elem, value); });
+}
+
+template<class RandomIt, class T, class Compare = std::less<>>
+RandomIt branchless_upper_bound(RandomIt first, RandomIt last, const T& value, Compare comp = {})
+{
+	return impl::branchless_partition_point(first, last, [&value, &comp](const auto& elem) { return !comp(value, elem); });
+}
+
+// lower/upper bound searching forward from hint with exponentially growing steps
+template<class RandomIt, class T, class Compare = std::less<>>
+RandomIt gallop_lower_bound(RandomIt hint, RandomIt last, const T& value, Compare comp = {})
+{
+	return impl::gallop_partition_point(hint, last, [&value, &comp](const auto& elem) { return comp(elem, value); });
+}
+
+template<class RandomIt, class T, class Compare = std::less<>>
+RandomIt gallop_upper_bound(RandomIt hint, RandomIt last, const T& value, Compare comp = {})
+{
+	return impl::gallop_partition_point(hint, last, [&value, &comp](const auto& elem) { return !comp(value, elem); });
+}
+
+// lower/upper bound choosing kernel by iterator category and element size
+template<class ForwardIt, class T, class Compare = std::less<>>
+ForwardIt fast_lower_bound(ForwardIt first, ForwardIt last, const T& value, Compare comp = {})
+{
+	if constexpr (impl::use_branchless_search_v<ForwardIt>) {
+		return branchless_lower_bound(first, last, value, comp);
+	}
+	else {
+		return std::lower_bound(first, last, value, comp);
+	}
+}
+
+template<class ForwardIt, class T, class Compare = std::less<>>
+ForwardIt fast_upper_bound(ForwardIt first, ForwardIt last, const T& value, Compare comp = {})
+{
+	if constexpr (impl::use_branchless_search_v<ForwardIt>) {
+		return branchless_upper_bound(first, last, value, comp);
+	}
+	else {
+		return std::upper_bound(first, last, value, comp);
+	}
+}
+
+// equal range sharing search steps of lower and upper bounds until the first equal element
+template<class ForwardIt, class T, class Compare = std::less<>>
+std::pair<ForwardIt, ForwardIt> fused_equal_range(ForwardIt first, ForwardIt last, const T& value, Compare comp = {})
+{
+	auto len = std::distance(first, last);
+	while (len > 0) {
+		const auto half = len / 2;
+		const auto middle = std::next(first, half);
+		if (comp(*middle, value)) {
+			first = std::next(middle);
+			len -= half + 1;
+		}
+		else if (comp(value, *middle)) {
+			len = half;
+		}
+		else {
+			return std::make_pair(fast_lower_bound(first, middle, value, comp), fast_upper_bound(std::next(middle), std::next(first, len), value, comp));
+		}
+	}
+
+	return std::make_pair(first, first);
+}
 
 
 template<class ForwardIt, class T, class Compare = std::less<>>
 ForwardIt binary_find(ForwardIt first, ForwardIt last, const T& value, Compare comp = {})
 {
-	first = std::lower_bound(first, last, value, comp);
+	first = fast_lower_bound(first, last, value, comp);
 	return first != last && !comp(value, *first) ? first : last;
 }
 
@@ -24,12 +214,8 @@ auto binary_find(const Container& cont, const T& value, Compare comp = {}) { ret
 template<class ForwardIt, class T, class Compare = std::less<>>
 auto binary_find_range(ForwardIt first, ForwardIt last, const T& value, Compare comp = {})
 {
-	first = std::lower_bound(first, last, value, comp);
-	if (first == last || comp(value, *first)) {
-		return std::make_pair(last, last);
-	}
-
-	return std::make_pair(first, std::upper_bound(first, last, value, comp));
+	const auto range = fused_equal_range(first, last, value, comp);
+	return (range.first == range.second) ? std::make_pair(last, last) : range;
 }
 
 template<class Container, class T, class Compare = std::less<>>
@@ -38,6 +224,410 @@ auto binary_find_range(Container& cont, const T& value, Compare comp = {}) { ret
 template<class Container, class T, class Compare = std::less<>>
 auto binary_find_range(const Container& cont, const T& value, Compare comp = {}) { return binary_find_range(std::cbegin(cont), std::cend(cont), value, comp); }
 
+namespace impl {
+
+	// count of independent searches interleaved by lower_bound_many
+	constexpr std::size_t interleave_width = 8;
+
+	// several branchless binary searches advanced in lockstep, so their cache misses overlap;
+	// the element which is compared at the next step is prefetched through RandomIt, so for iterators over permutations
+	// (const_iterator of sorted_vector) it is the element the position points to, the position itself is a plain load
+	template<class RandomIt, class ForwardIt, class OutputIt, class Compare, class Projection>
+	OutputIt interleaved_lower_bound(RandomIt first, RandomIt last, ForwardIt keysFirst, ForwardIt keysLast, OutputIt out, Compare comp, Projection proj)
+	{
+		const auto count = last - first;
+
+		ForwardIt keys[interleave_width];
+		RandomIt bases[interleave_width];
+		while (keysFirst != keysLast) {
+			std::size_t width = 0;
+			for (; width < interleave_width && keysFirst != keysLast; ++width, ++keysFirst) {
+				keys[width] = keysFirst;
+				bases[width] = first;
+			}
+
+			if (count > 0) {
+				for (auto len = count; len > 1; ) {
+					const auto half = len / 2;
+					len -= half;
+					for (std::size_t i = 0; i < width; ++i) {
+						bases[i] = comp(bases[i][half], *keys[i]) ? bases[i] + half : bases[i];
+						prefetch(std::addressof(bases[i][len / 2]));
+					}
+				}
+
+				for (std::size_t i = 0; i < width; ++i) {
+					bases[i] += comp(*bases[i], *keys[i]) ? 1 : 0;
+				}
+			}
+
+			for (std::size_t i = 0; i < width; ++i) {
+				*out++ = proj(bases[i], *keys[i]);
+			}
+		}
+
+		return out;
+	}
+
+	// merge join of sorted keys against the sorted range
+	template<class RandomIt, class InputIt, class OutputIt, class Compare, class Projection>
+	OutputIt galloping_lower_bound(RandomIt first, RandomIt last, InputIt keysFirst, InputIt keysLast, OutputIt out, Compare comp, Projection proj)
+	{
+		for (; keysFirst != keysLast; ++keysFirst) {
+			first = gallop_lower_bound(first, last, *keysFirst, comp);
+			*out++ = proj(first, *keysFirst);
+		}
+
+		return out;
+	}
+
+	template<class RandomIt, class Compare>
+	auto make_find_projection(RandomIt last, Compare comp)
+	{
+		return [last, comp](RandomIt it, const auto& key) { return it != last && !comp(key, *it) ? it : last; };
+	}
+
+	template<class RandomIt>
+	auto make_identity_projection() { return [](RandomIt it, const auto&) { return it; }; }
+}
+
+// lower bound of every key from [keysFirst, keysLast) written to out
+template<class RandomIt, class ForwardIt, class OutputIt, class Compare = std::less<>>
+OutputIt lower_bound_many(RandomIt first, RandomIt last, ForwardIt keysFirst, ForwardIt keysLast, OutputIt out, Compare comp = {})
+{
+	return impl::interleaved_lower_bound(first, last, keysFirst, keysLast, out, comp, impl::make_identity_projection<RandomIt>());
+}
+
+template<class RandomIt, class InputIt, class OutputIt, class Compare = std::less<>>
+OutputIt lower_bound_many(sorted_range_t, RandomIt first, RandomIt last, InputIt keysFirst, InputIt keysLast, OutputIt out, Compare comp = {})
+{
+	return impl::galloping_lower_bound(first, last, keysFirst, keysLast, out, comp, impl::make_identity_projection<RandomIt>());
+}
+
+// binary_find of every key from [keysFirst, keysLast) written to out
+template<class RandomIt, class ForwardIt, class OutputIt, class Compare = std::less<>>
+OutputIt binary_find_many(RandomIt first, RandomIt last, ForwardIt keysFirst, ForwardIt keysLast, OutputIt out, Compare comp = {})
+{
+	return impl::interleaved_lower_bound(first, last, keysFirst, keysLast, out, comp, impl::make_find_projection(last, comp));
+}
+
+template<class RandomIt, class InputIt, class OutputIt, class Compare = std::less<>>
+OutputIt binary_find_many(sorted_range_t, RandomIt first, RandomIt last, InputIt keysFirst, InputIt keysLast, OutputIt out, Compare comp = {})
+{
+	return impl::galloping_lower_bound(first, last, keysFirst, keysLast, out, comp, impl::make_find_projection(last, comp));
+}
+
+namespace impl {
+
+	// ranges shorter than this are sorted by std::stable_sort instead of radix sort
+	constexpr std::ptrdiff_t radix_sort_min_size = 256;
+
+	// ranges are split between threads only by chunks not shorter than this
+	constexpr std::size_t parallel_sort_min_chunk = 1 << 15;
+
+	template<class RandomIt, class BufferIt, class KeyOf>
+	void string_radix_sort_impl(RandomIt first, RandomIt last, BufferIt buffer, std::size_t depth, KeyOf keyOf)
+	{
+		if ((last - first) < radix_sort_min_size) {
+			std::stable_sort(first, last, [depth, &keyOf](const auto& left, const auto& right) {
+				return keyOf(left).compare(depth, std::string::npos, keyOf(right), depth, std::string::npos) < 0;
+			});
+			return;
+		}
+
+		// bucket 0 is for keys ending before depth, bucket (c + 1) for keys having char c at depth
+		const auto bucket_of = [&depth, &keyOf](const auto& elem) -> std::size_t {
+			const auto& key = keyOf(elem);
+			return (depth < key.size()) ? static_cast<unsigned char>(key[depth]) + std::size_t{ 1 } : 0;
+		};
+
+		constexpr std::size_t buckets_count = std::numeric_limits<unsigned char>::max() + std::size_t{ 2 };
+		std::ptrdiff_t bucketsFirst[buckets_count + 1] = {};
+		for (;;) {
+			std::fill(std::begin(bucketsFirst), std::end(bucketsFirst), 0);
+			for (auto it = first; it != last; ++it) {
+				++bucketsFirst[bucket_of(*it) + 1];
+			}
+
+			// skipping common prefix without recursion
+			const auto commonBucket = std::find(std::cbegin(bucketsFirst), std::cend(bucketsFirst), last - first);
+			if (commonBucket == std::cend(bucketsFirst)) {
+				break;
+			}
+			if (commonBucket == std::cbegin(bucketsFirst) + 1) {
+				return;		// all keys are equal
+			}
+			++depth;
+		}
+
+		for (std::size_t i = 1; i <= buckets_count; ++i) {
+			bucketsFirst[i] += bucketsFirst[i - 1];
+		}
+
+		std::ptrdiff_t positions[buckets_count];
+		std::copy(bucketsFirst, bucketsFirst + buckets_count, positions);
+		for (auto it = first; it != last; ++it) {
+			buffer[positions[bucket_of(*it)]++] = std::move(*it);
+		}
+		std::move(buffer, buffer + (last - first), first);
+
+		for (std::size_t i = 1; i < buckets_count; ++i) {
+			if (bucketsFirst[i + 1] - bucketsFirst[i] > 1) {
+				string_radix_sort_impl(first + bucketsFirst[i], first + bucketsFirst[i + 1], buffer + bucketsFirst[i], depth + 1, keyOf);
+			}
+		}
+	}
+}
+
+// stable LSD radix sort by integral key returned by keyOf
+template<class RandomIt, class KeyOf>
+void radix_sort(RandomIt first, RandomIt last, KeyOf keyOf)
+{
+	using value_type = typename std::iterator_traits<RandomIt>::value_type;
+	using key_type = std::decay_t<decltype(keyOf(*first))>;
+	static_assert(std::is_integral_v<key_type> && !std::is_same_v<key_type, bool>, "radix_sort requires integral keys");
+
+	using unsigned_key = std::make_unsigned_t<key_type>;
+	constexpr unsigned_key sign_flip = std::is_signed_v<key_type> ? unsigned_key(unsigned_key(1) << (std::numeric_limits<unsigned_key>::digits - 1)) : unsigned_key(0);
+	constexpr std::size_t digits_count = sizeof(key_type);
+	constexpr std::size_t digit_values = 256;
+
+	const auto count = last - first;
+	if (count < impl::radix_sort_min_size) {
+		std::stable_sort(first, last, [&keyOf](const auto& left, const auto& right) { return keyOf(left) < keyOf(right); });
+		return;
+	}
+
+	const auto digit_of = [&keyOf](const value_type& elem, std::size_t digit) {
+		return static_cast<std::size_t>((static_cast<unsigned_key>(keyOf(elem)) ^ sign_flip) >> (digit * 8)) & (digit_values - 1);
+	};
+
+	std::vector<std::array<std::ptrdiff_t, digit_values>> histograms(digits_count);
+	for (auto it = first; it != last; ++it) {
+		for (std::size_t digit = 0; digit < digits_count; ++digit) {
+			++histograms[digit][digit_of(*it, digit)];
+		}
+	}
+
+	std::vector<value_type> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+	bool inBuffer = true;
+	for (std::size_t digit = 0; digit < digits_count; ++digit) {
+		auto& histogram = histograms[digit];
+		if (std::find(std::cbegin(histogram), std::cend(histogram), count) != std::cend(histogram)) {
+			continue;	// all elements have the same digit
+		}
+
+		std::ptrdiff_t position = 0;
+		for (auto& digitCount : histogram) {
+			position += std::exchange(digitCount, position);
+		}
+
+		const auto scatter = [&](auto srcFirst, auto srcLast, auto dest) {
+			for (; srcFirst != srcLast; ++srcFirst) {
+				dest[histogram[digit_of(*srcFirst, digit)]++] = std::move(*srcFirst);
+			}
+		};
+
+		if (inBuffer) {
+			scatter(std::begin(buffer), std::end(buffer), first);
+		}
+		else {
+			scatter(first, last, std::begin(buffer));
+		}
+		inBuffer = !inBuffer;
+	}
+
+	if (inBuffer) {
+		std::move(std::begin(buffer), std::end(buffer), first);
+	}
+}
+
+// stable MSD radix sort by std::string key returned (by reference) by keyOf
+template<class RandomIt, class KeyOf>
+void string_radix_sort(RandomIt first, RandomIt last, KeyOf keyOf)
+{
+	using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+	// buffer is only a scatter target, so its elements are default constructed when possible instead of moved from the range and back
+	std::vector<value_type> buffer;
+	if constexpr (std::is_default_constructible_v<value_type>) {
+		buffer.resize(static_cast<std::size_t>(last - first));
+	}
+	else {
+		buffer.assign(std::make_move_iterator(first), std::make_move_iterator(last));
+		std::move(std::begin(buffer), std::end(buffer), first);
+	}
+	impl::string_radix_sort_impl(first, last, std::begin(buffer), 0, keyOf);
+}
+
+// stable merge sort: chunks are sorted and then merged pairwise on threadsCount threads
+template<class RandomIt, class Compare = std::less<>>
+void parallel_stable_sort(RandomIt first, RandomIt last, Compare comp = {}, std::size_t threadsCount = std::thread::hardware_concurrency())
+{
+	const auto count = static_cast<std::size_t>(last - first);
+	threadsCount = std::min(threadsCount, count / impl::parallel_sort_min_chunk);
+	if (threadsCount <= 1) {
+		std::stable_sort(first, last, comp);
+		return;
+	}
+
+	const auto chunkSize = (count + threadsCount - 1) / threadsCount;
+	const auto chunkFirst = [first, count](std::size_t chunk, std::size_t size) { return first + std::min(chunk * size, count); };
+
+	parallel_chunks(threadsCount, threadsCount, [&](std::size_t firstChunk, std::size_t lastChunk) {
+		for (; firstChunk != lastChunk; ++firstChunk) {
+			std::stable_sort(chunkFirst(firstChunk, chunkSize), chunkFirst(firstChunk + 1, chunkSize), comp);
+		}
+	});
+
+	for (auto width = chunkSize; width < count; width *= 2) {
+		const auto mergesCount = (count + 2 * width - 1) / (2 * width);
+		parallel_chunks(mergesCount, threadsCount, [&](std::size_t firstMerge, std::size_t lastMerge) {
+			for (; firstMerge != lastMerge; ++firstMerge) {
+				std::inplace_merge(chunkFirst(2 * firstMerge, width), chunkFirst(2 * firstMerge + 1, width), chunkFirst(2 * firstMerge + 2, width), comp);
+			}
+		});
+	}
+}
+
+namespace impl {
+
+	// continues stable merge of left[leftPos, leftLast) and right[rightPos, rightLast) to back of out, moves at most budget elements and returns their count
+	template<class Vec, class Compare>
+	std::size_t merge_step(Vec& left, std::size_t& leftPos, std::size_t leftLast, Vec& right, std::size_t& rightPos, std::size_t rightLast, Vec& out, std::size_t budget, Compare& comp)
+	{
+		std::size_t moved = 0;
+		for (; moved < budget && leftPos < leftLast && rightPos < rightLast; ++moved) {
+			if (comp(right[rightPos], left[leftPos])) {
+				out.push_back(std::move(right[rightPos++]));
+			}
+			else {
+				out.push_back(std::move(left[leftPos++]));
+			}
+		}
+
+		for (; moved < budget && leftPos < leftLast; ++moved) {
+			out.push_back(std::move(left[leftPos++]));
+		}
+		for (; moved < budget && rightPos < rightLast; ++moved) {
+			out.push_back(std::move(right[rightPos++]));
+		}
+		return moved;
+	}
+}
+
+// stable merge sort of owned vector, which can be suspended between steps,
+// comp passed to every step must give the same order
+template<class T, class Allocator = std::allocator<T>>
+class incremental_sort {
+public:
+	// runs of this size are sorted at once before merging
+	static constexpr std::size_t initial_run_size = 32;
+
+	incremental_sort() = default;
+	explicit incremental_sort(std::vector<T, Allocator>&& elems) : elems_{ std::move(elems) } { buffer_.reserve(elems_.size()); }
+
+	// sorts or merges about budget elements, returns true if all elements are sorted
+	template<class Compare>
+	bool step(std::size_t budget, Compare comp)
+	{
+		const auto count = elems_.size();
+		while (!done_ && budget > 0) {
+			if (width_ == 0) {
+				const auto runLast = std::min(count, run_ + initial_run_size);
+				std::stable_sort(std::begin(elems_) + run_, std::begin(elems_) + runLast, comp);
+				budget -= std::min(budget, runLast - run_);
+				run_ = runLast;
+				if (run_ == count) start_pass(initial_run_size);
+			}
+			else if (left_ == leftLast_ && right_ == rightLast_) {
+				if (rightLast_ == count) {
+					elems_.swap(buffer_);
+					buffer_.clear();
+					start_pass(width_ * 2);
+				}
+				else {
+					start_merge(rightLast_);
+				}
+			}
+			else {
+				budget -= impl::merge_step(elems_, left_, leftLast_, elems_, right_, rightLast_, buffer_, budget, comp);
+			}
+		}
+		return done_;
+	}
+
+	bool done() const { return done_; }
+
+	// sorted elements, can be taken only when sorting is done
+	auto release() -> std::vector<T, Allocator>
+	{
+		assert(done_);
+		return std::move(elems_);
+	}
+
+private:
+	void start_pass(std::size_t width)
+	{
+		width_ = width;
+		done_ = width_ >= elems_.size();
+		if (!done_) start_merge(0);
+	}
+
+	void start_merge(std::size_t first)
+	{
+		left_ = first;
+		leftLast_ = std::min(elems_.size(), first + width_);
+		right_ = leftLast_;
+		rightLast_ = std::min(elems_.size(), first + 2 * width_);
+	}
+
+private:
+	std::vector<T, Allocator> elems_;
+	std::vector<T, Allocator> buffer_;
+	std::size_t run_ = 0;
+	std::size_t width_ = 0;
+	std::size_t left_ = 0;
+	std::size_t leftLast_ = 0;
+	std::size_t right_ = 0;
+	std::size_t rightLast_ = 0;
+	bool done_ = false;
+};
+
+// stable merge of two owned sorted vectors, which can be suspended between steps,
+// comp passed to every step must give the same order
+template<class T, class Allocator = std::allocator<T>>
+class incremental_merge {
+public:
+	incremental_merge() = default;
+	incremental_merge(std::vector<T, Allocator>&& left, std::vector<T, Allocator>&& right)
+		: left_{ std::move(left) }, right_{ std::move(right) } { result_.reserve(left_.size() + right_.size()); }
+
+	// merges at most budget elements, returns true if all elements are merged
+	template<class Compare>
+	bool step(std::size_t budget, Compare comp)
+	{
+		impl::merge_step(left_, leftPos_, left_.size(), right_, rightPos_, right_.size(), result_, budget, comp);
+		return done();
+	}
+
+	bool done() const { return leftPos_ == left_.size() && rightPos_ == right_.size(); }
+
+	// merged elements, can be taken only when merging is done
+	auto release() -> std::vector<T, Allocator>
+	{
+		assert(done());
+		return std::move(result_);
+	}
+
+private:
+	std::vector<T, Allocator> left_;
+	std::vector<T, Allocator> right_;
+	std::vector<T, Allocator> result_;
+	std::size_t leftPos_ = 0;
+	std::size_t rightPos_ = 0;
+};
+
 template<class T, class Pred>
 void remove_if(std::set<T>& cont, Pred pred = {})
 {
@@ -4,18 +4,25 @@
 
 #include "key_value_pair_adapters.hpp"
 #include "algorithms_utils.hpp"
+#include "hash_index.hpp"
+#include "bloom_filter.hpp"
 
 #include <utility>
 #include <vector>
 #include <algorithm>
 #include <cassert>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <initializer_list>
 
 
 template<
 	class Key, 
 	class T, 
 	class Comparator = std::less<Key>, 
-	class Allocator = std::allocator<std::pair<Key, T>>
+	class Allocator = std::allocator<std::pair<Key, T>>,
+	class Hash = void	// optional hash index for exact key lookups, equivalent keys must have equal hashes
 >
 class assoc_vector {
 	class iterator_adapter_impl;
@@ -24,6 +31,9 @@ class assoc_vector {
 public:
 	using container_type = std::vector<std::pair<Key, T>, Allocator>;
 
+	using key_type = Key;
+	using mapped_type = T;
+	using key_compare = Comparator;
 	using value_type = typename container_type::value_type;
 	using allocator_type = typename container_type::allocator_type;
 	using size_type	= typename container_type::size_type;
@@ -41,26 +51,51 @@ public:
 	using reverse_iterator = std::reverse_iterator<iterator>;
 	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+	assoc_vector() = default;
+
+	template<class It>
+	assoc_vector(It first, It last) { assign(first, last); }
+	assoc_vector(std::initializer_list<value_type> ilist) { assign(ilist.begin(), ilist.end()); }
+
+	// takes ownership of elems, which are sorted in place
+	explicit assoc_vector(container_type&& elems) : elems_{ std::move(elems) } { sort_unique_elems(); }
+
+	// takes ownership of elems, which must be already sorted by Comparator without equivalent keys
+	assoc_vector(sorted_range_t, container_type&& elems) : elems_{ std::move(elems) }
+	{
+		assert(std::adjacent_find(std::cbegin(elems_), std::cend(elems_), [](const value_type& left, const value_type& right) { return !CompareFirstAdapter<Comparator>()(left, right); }) == std::cend(elems_));
+		rebuild_indexes();
+	}
+
 	T& at(const Key& key)
 	{
-		const auto it = binary_find(std::begin(elems_), std::end(elems_), key, CompareFirstAdapter<Comparator>());
+		const auto it = find_elem(key);
 		if (it == std::end(elems_)) {
 			throw std::out_of_range{ "key is out of range" };
 		}
-		return *it;
+		return it->second;
 	}
 	const T& at(const Key& key) const
 	{
-		const auto it = binary_find(std::cbegin(elems_), std::cend(elems_), key, CompareFirstAdapter<Comparator>());
+		const auto it = find_elem(key);
 		if (it == std::cend(elems_)) {
 			throw std::out_of_range{ "key is out of range" };
 		}
-		return *it;
+		return it->second;
 	}
 	T& operator[](const Key& key)
 	{
+		if constexpr (hashed) {
+			if (hash_index_ready()) {
+				const auto it = find_elem(key);
+				if (it != std::end(elems_)) {
+					return it->second;
+				}
+			}
+		}
+
 		CompareFirstAdapter<Comparator> comp;
-		auto it = std::lower_bound(std::begin(elems_), std::end(elems_), key, comp);
+		auto it = fast_lower_bound(std::begin(elems_), std::end(elems_), key, comp);
 		if (it == std::end(elems_) || comp(key, *it)) {
 			return this->emplace_hint(const_iterator(it), key, T())->second;
 		}
@@ -70,30 +105,17 @@ public:
 	}
 	const T& operator[](const Key& key) const { return at(key); }
 
+	// keys are unique as in std::map: if key is already present, nothing is inserted and present element is returned with false
 	std::pair<iterator, bool> insert(const value_type& value)
 	{
-		const auto it = std::lower_bound(std::begin(elems_), std::end(elems_), value, CompareFirstAdapter<Comparator>());
-		return std::make_pair(iterator(elems_.insert(it, value)), true);
-	}
-	iterator insert(const_iterator hint, const value_type& value)
-	{
-		if (hint < std::cbegin(elems_) || hint > std::cend(elems_)) {
-			throw std::out_of_range{"iterator is out of range"};
-		}
-
 		CompareFirstAdapter<Comparator> comp;
-		const auto first = std::cbegin(elems_);
-		const auto last = std::cend(elems_);
-
-		if ((hint == last && (hint == first || !comp(value, *(std::prev(hint))))) ||	// if no elems or value isn't less than prev element of last
-			(hint == first && comp(value, *hint)) ||									// if value is less than first
-			(!comp(value, *(std::prev(hint))) && comp(value, *hint)))					// if value is less than hint and not less than prev
-		{
-			return iterator(elems_.insert(hint, value));
+		const auto it = fast_lower_bound(std::begin(elems_), std::end(elems_), value, comp);
+		if (it != std::end(elems_) && !comp(value, *it)) {
+			return std::make_pair(iterator(it), false);
 		}
-		
-		return this->insert(value).first;
+		return std::make_pair(iterator(insert_elem(it, value_type(value))), true);
 	}
+	iterator insert(const_iterator hint, const value_type& value) { return emplace_hint(hint, value); }
 	template< class InputIt >
 	void insert(InputIt first, InputIt last)
 	{
@@ -106,9 +128,13 @@ public:
 	template<class... Args>
 	std::pair<iterator, bool> emplace(Args&&... args)
 	{
+		CompareFirstAdapter<Comparator> comp;
 		value_type value(std::forward<Args>(args)...);
-		const auto it = std::lower_bound(std::begin(elems_), std::end(elems_), value, CompareFirstAdapter<Comparator>());
-		return std::make_pair(iterator(elems_.insert(it, std::move(value))), true);
+		const auto it = fast_lower_bound(std::begin(elems_), std::end(elems_), value, comp);
+		if (it != std::end(elems_) && !comp(value, *it)) {
+			return std::make_pair(iterator(it), false);
+		}
+		return std::make_pair(iterator(insert_elem(it, std::move(value))), true);
 	}
 	template<class... Args>
 	iterator emplace_hint(const_iterator hint, Args&&... args)
@@ -125,56 +151,189 @@ public:
 
 		value_type value(std::forward<Args>(args)...);
 
-		if ((elems_hint == last && (elems_hint == first || !comp(value, *(std::prev(elems_hint))))) ||	// if no elems or value isn't less than prev element of last
+		if ((elems_hint == last && (elems_hint == first || comp(*(std::prev(elems_hint)), value))) ||	// if no elems or value is greater than prev element of last
 			(elems_hint == first && comp(value, *elems_hint)) ||									// if value is less than first
-			(!comp(value, *(std::prev(elems_hint))) && comp(value, *elems_hint)))					// if value is less than hint and not less than prev
+			(elems_hint != first && elems_hint != last && comp(*(std::prev(elems_hint)), value) && comp(value, *elems_hint)))	// if value is less than hint and greater than prev
 		{
-			return iterator(elems_.insert(elems_hint, std::move(value)));
+			return iterator(insert_elem(elems_hint, std::move(value)));
 		}
 
-		return this->insert(value).first;
+		return this->emplace(std::move(value)).first;
 	}
 
 	iterator erase(const value_type& value)
 	{
 		auto it = binary_find(elems_, value, CompareFirstAdapter<Comparator>());
-		return iterator((it != std::end(elems_)) ? elems_.erase(it) : it);
+		return iterator((it != std::end(elems_)) ? erase_elem(it) : it);
 	}
 	void eraseAll(const value_type& value)
 	{
-		const auto itPair = std::equal_range(std::cbegin(elems_), std::cend(elems_), value, CompareFirstAdapter<Comparator>());
+		const auto itPair = fused_equal_range(std::cbegin(elems_), std::cend(elems_), value, CompareFirstAdapter<Comparator>());
 		iterator(elems_.erase(itPair.first, itPair.second));
+		rebuild_indexes();
+	}
+
+	// erases all elements for which pred(const value_type&) is true in single pass, returns count of erased elements
+	template<class Pred>
+	size_type erase_if(Pred pred)
+	{
+		auto write = std::begin(elems_);
+		for (auto read = std::begin(elems_); read != std::end(elems_); ++read) {
+			if (pred(std::as_const(*read))) continue;
+			if (write != read) *write = std::move(*read);
+			++write;
+		}
+
+		const auto erasedCount = static_cast<size_type>(std::end(elems_) - write);
+		if (erasedCount != 0) {
+			elems_.erase(write, std::end(elems_));
+			rebuild_indexes();
+		}
+		return erasedCount;
+	}
+
+	// erases elements with keys from [keysFirst, keysLast), returns count of erased elements
+	template<class InputIt, typename = enable_if_iterator<InputIt>>
+	size_type erase(InputIt keysFirst, InputIt keysLast)
+	{
+		Comparator comp;
+		std::vector<Key> keys(keysFirst, keysLast);
+		std::sort(std::begin(keys), std::end(keys), comp);
+
+		// elements and keys are both sorted, so keys are walked forward together with elements
+		auto currKey = std::cbegin(keys);
+		return erase_if([&currKey, &keys, &comp](const value_type& elem) {
+			currKey = gallop_lower_bound(currKey, std::cend(keys), elem.first, comp);
+			return currKey != std::cend(keys) && !comp(elem.first, *currKey);
+		});
 	}
 
-	iterator find(const Key& key) { return iterator(binary_find(elems_, key, CompareFirstAdapter<Comparator>())); }
-	const_iterator find(const Key& key) const { return const_iterator(binary_find(elems_, key, CompareFirstAdapter<Comparator>())); }
+	iterator find(const Key& key) { return iterator(find_elem(key)); }
+	const_iterator find(const Key& key) const { return const_iterator(find_elem(key)); }
+
+	// batched find: iterator to every key from [first, last) (or end() if missing) is written to out
+	template<class ForwardIt, class OutputIt>
+	OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) { return impl::interleaved_lower_bound(std::begin(elems_), std::end(elems_), first, last, out, CompareFirstAdapter<Comparator>(), find_projection<iterator>(std::end(elems_))); }
+	template<class ForwardIt, class OutputIt>
+	OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const { return impl::interleaved_lower_bound(std::cbegin(elems_), std::cend(elems_), first, last, out, CompareFirstAdapter<Comparator>(), find_projection<const_iterator>(std::cend(elems_))); }
+
+	template<class InputIt, class OutputIt>
+	OutputIt find_many(sorted_range_t, InputIt first, InputIt last, OutputIt out) { return impl::galloping_lower_bound(std::begin(elems_), std::end(elems_), first, last, out, CompareFirstAdapter<Comparator>(), find_projection<iterator>(std::end(elems_))); }
+	template<class InputIt, class OutputIt>
+	OutputIt find_many(sorted_range_t, InputIt first, InputIt last, OutputIt out) const { return impl::galloping_lower_bound(std::cbegin(elems_), std::cend(elems_), first, last, out, CompareFirstAdapter<Comparator>(), find_projection<const_iterator>(std::cend(elems_))); }
+
+	template<class ForwardIt, class OutputIt>
+	OutputIt lower_bound_many(ForwardIt first, ForwardIt last, OutputIt out) { return impl::interleaved_lower_bound(std::begin(elems_), std::end(elems_), first, last, out, CompareFirstAdapter<Comparator>(), bound_projection<iterator>()); }
+	template<class ForwardIt, class OutputIt>
+	OutputIt lower_bound_many(ForwardIt first, ForwardIt last, OutputIt out) const { return impl::interleaved_lower_bound(std::cbegin(elems_), std::cend(elems_), first, last, out, CompareFirstAdapter<Comparator>(), bound_projection<const_iterator>()); }
+
+	template<class InputIt, class OutputIt>
+	OutputIt lower_bound_many(sorted_range_t, InputIt first, InputIt last, OutputIt out) { return impl::galloping_lower_bound(std::begin(elems_), std::end(elems_), first, last, out, CompareFirstAdapter<Comparator>(), bound_projection<iterator>()); }
+	template<class InputIt, class OutputIt>
+	OutputIt lower_bound_many(sorted_range_t, InputIt first, InputIt last, OutputIt out) const { return impl::galloping_lower_bound(std::cbegin(elems_), std::cend(elems_), first, last, out, CompareFirstAdapter<Comparator>(), bound_projection<const_iterator>()); }
 
 	std::pair<iterator, iterator> equal_range(const Key& key) 
 	{ 
-		auto result = std::equal_range(std::begin(elems_), std::end(elems_), key, CompareFirstAdapter<Comparator>());
+		auto result = fused_equal_range(std::begin(elems_), std::end(elems_), key, CompareFirstAdapter<Comparator>());
 		return std::make_pair(iterator(result.first), iterator(result.second));
 	}
-	std::pair<const_iterator, const_iterator> equal_range(const Key& key) const { return const_iterator(std::equal_range(std::cbegin(elems_), std::cend(elems_), key, CompareFirstAdapter<Comparator>())); }
+	std::pair<const_iterator, const_iterator> equal_range(const Key& key) const
+	{
+		auto result = fused_equal_range(std::cbegin(elems_), std::cend(elems_), key, CompareFirstAdapter<Comparator>());
+		return std::make_pair(const_iterator(result.first), const_iterator(result.second));
+	}
 
-	iterator lower_bound(const Key& key) { return iterator(std::lower_bound(std::begin(elems_), std::end(elems_), key, CompareFirstAdapter<Comparator>())); }
-	const_iterator lower_bound(const Key& key) const { return const_iterator(std::lower_bound(std::cbegin(elems_), std::cend(elems_), key, CompareFirstAdapter<Comparator>())); }
+	iterator lower_bound(const Key& key) { return iterator(fast_lower_bound(std::begin(elems_), std::end(elems_), key, CompareFirstAdapter<Comparator>())); }
+	const_iterator lower_bound(const Key& key) const { return const_iterator(fast_lower_bound(std::cbegin(elems_), std::cend(elems_), key, CompareFirstAdapter<Comparator>())); }
 
-	iterator upper_bound(const Key& key) { return iterator(std::upper_bound(std::begin(elems_), std::end(elems_), key, CompareFirstAdapter<Comparator>())); }
-	const_iterator upper_bound(const Key& key) const { return const_iterator(std::upper_bound(std::cbegin(elems_), std::cend(elems_), key, CompareFirstAdapter<Comparator>())); }
+	iterator upper_bound(const Key& key) { return iterator(fast_upper_bound(std::begin(elems_), std::end(elems_), key, CompareFirstAdapter<Comparator>())); }
+	const_iterator upper_bound(const Key& key) const { return const_iterator(fast_upper_bound(std::cbegin(elems_), std::cend(elems_), key, CompareFirstAdapter<Comparator>())); }
 
+	// elements with equivalent keys are dropped except of the first one
 	template<class It>
 	void assign(It first, It last)
 	{
 		elems_.assign(first, last);
-		std::sort(std::begin(elems_), std::end(elems_));
+		sort_unique_elems();
 	}
 
 	template<class Cont>
-	void assign(const Cont& other) { assign(std::cbegin(other), std::cend(other)); }
+	void assign(Cont&& other)
+	{
+		if constexpr (std::is_same_v<std::decay_t<Cont>, container_type> && !std::is_lvalue_reference_v<Cont>) {
+			elems_ = std::move(other);
+			sort_unique_elems();
+		}
+		else if constexpr (!std::is_lvalue_reference_v<Cont>) {
+			assign(std::make_move_iterator(std::begin(other)), std::make_move_iterator(std::end(other)));
+		}
+		else {
+			assign(std::cbegin(other), std::cend(other));
+		}
+	}
+
+	void clear() { elems_.clear(); rebuild_indexes(); }
+
+	// moves underlying sorted vector out, leaving container empty
+	container_type release()
+	{
+		container_type result = std::move(elems_);
+		clear();
+		return result;
+	}
+
+	// assignment spread over many step() calls: elements are sorted and deduplicated by parts of limited size,
+	// container built from them is taken by result() when step() returns true
+	class incremental_assign {
+	public:
+		explicit incremental_assign(container_type&& elems) : sort_{ std::move(elems) } {}
+
+		// processes about budget elements, returns true if result is ready
+		bool step(size_type budget)
+		{
+			CompareFirstAdapter<Comparator> comp;
+			if (!sort_.done()) {
+				if (sort_.step(budget, comp)) elems_ = sort_.release();
+				return false;
+			}
+
+			// elements equivalent to the previous kept one are dropped
+			for (; budget > 0 && read_ < elems_.size(); --budget, ++read_) {
+				if (write_ != 0 && !comp(elems_[write_ - 1], elems_[read_])) continue;
+				if (write_ != read_) elems_[write_] = std::move(elems_[read_]);
+				++write_;
+			}
+
+			if (read_ == elems_.size() && write_ != elems_.size()) {
+				elems_.erase(std::begin(elems_) + write_, std::end(elems_));
+				read_ = write_;
+			}
+			return done();
+		}
+
+		bool done() const { return sort_.done() && read_ == write_ && write_ == elems_.size(); }
+
+		// built container, can be taken only when step() returned true
+		auto result() -> assoc_vector
+		{
+			assert(done());
+			return assoc_vector(sorted_range, std::move(elems_));
+		}
+
+	private:
+		incremental_sort<value_type, Allocator> sort_;
+		container_type elems_;
+		size_type read_ = 0;
+		size_type write_ = 0;
+	};
 
-	void clear() { elems_.clear(); }
 	bool empty() const { return elems_.empty(); }
-	void swap(assoc_vector& other) { elems_.swap(other.elems_); }
+	void swap(assoc_vector& other)
+	{
+		elems_.swap(other.elems_);
+		if constexpr (hashed) hashIndex_.swap(other.hashIndex_);
+		std::swap(bloomFilter_, other.bloomFilter_);
+	}
 	allocator_type get_allocator() const { return elems_.get_allocator(); }
 
 	size_type size() const { return elems_.size(); }
@@ -183,8 +342,8 @@ public:
 	void reserve(size_type sz) { elems_.reserve(sz); }
 	void shrink_to_fit() { elems_.shrink_to_fit(); }
 
-	const T& at_index(size_type index) const { return elems_.at(index); }
-	T& at_index(size_type index) { return elems_.at(index); }
+	const T& at_index(size_type index) const { return elems_.at(index).second; }
+	T& at_index(size_type index) { return elems_.at(index).second; }
 
 	iterator begin() { return iterator(elems_.begin()); }
 	iterator end() { return iterator(elems_.end()); }
@@ -213,9 +372,96 @@ public:
 	friend bool operator>(assoc_vector& left, assoc_vector& right) { return left.elems_ > right.elems_; }
 	friend bool operator<=(assoc_vector& left, assoc_vector& right) { return left.elems_ <= right.elems_; }
 
+private:
+	static constexpr bool radix_sortable =
+		(std::is_same_v<Comparator, std::less<Key>> || std::is_same_v<Comparator, std::less<>>) &&
+		((std::is_integral_v<Key> && !std::is_same_v<Key, bool>) || std::is_same_v<Key, std::string>);
+
+	void sort_unique_elems()
+	{
+		CompareFirstAdapter<Comparator> comp;
+		if constexpr (radix_sortable && std::is_integral_v<Key>) {
+			radix_sort(std::begin(elems_), std::end(elems_), [](const value_type& elem) { return elem.first; });
+		}
+		else if constexpr (radix_sortable) {
+			string_radix_sort(std::begin(elems_), std::end(elems_), [](const value_type& elem) -> const Key& { return elem.first; });
+		}
+		else {
+			parallel_stable_sort(std::begin(elems_), std::end(elems_), comp);
+		}
+
+		// deduplication is a separate linear pass after sorting, sorts are stable so the first of equivalent keys is kept
+		elems_.erase(std::unique(std::begin(elems_), std::end(elems_), [comp](const value_type& left, const value_type& right) { return !comp(left, right); }), std::end(elems_));
+		rebuild_indexes();
+	}
+
+	auto insert_elem(typename container_type::const_iterator pos, value_type&& value) -> typename container_type::iterator
+	{
+		const auto it = elems_.insert(pos, std::move(value));
+		if constexpr (hashed) hashIndex_.invalidate();
+		if (!bloomFilter_.add(it->first)) rebuild_bloom_filter();
+		return it;
+	}
+
+	auto erase_elem(typename container_type::const_iterator pos) -> typename container_type::iterator
+	{
+		if constexpr (hashed) hashIndex_.invalidate();
+		const auto it = elems_.erase(pos);
+		if (bloomFilter_.remove()) rebuild_bloom_filter();
+		return it;
+	}
+
+	void rebuild_indexes()
+	{
+		if constexpr (hashed) rebuild_hash_index();
+		rebuild_bloom_filter();
+	}
+
+	void rebuild_hash_index() { hashIndex_.rebuild(std::cbegin(elems_), std::cend(elems_), [](const value_type& elem) -> const Key& { return elem.first; }); }
+
+	// invalid hash index is rebuilt lazily, once lookups done by binary search since last rebuild have paid for it
+	bool hash_index_ready()
+	{
+		if (!hashIndex_.valid() && hashIndex_.stale_lookup(elems_.size())) {
+			rebuild_hash_index();
+		}
+		return hashIndex_.valid();
+	}
+	bool hash_index_ready() const { return hashIndex_.valid(); }
+
+	void rebuild_bloom_filter() { bloomFilter_.rebuild(std::cbegin(elems_), std::cend(elems_), [](const value_type& elem) -> const Key& { return elem.first; }); }
+
+	template<class Self>
+	static auto find_elem_impl(Self& self, const Key& key)
+	{
+		if constexpr (hashed) {
+			if (self.hash_index_ready()) {
+				CompareFirstAdapter<Comparator> comp;
+				const auto position = self.hashIndex_.find(key, [&self, &key, &comp](size_type pos) {
+					const auto& elemKey = self.elems_[pos].first;
+					return !comp(elemKey, key) && !comp(key, elemKey);
+				});
+				return (position != hash_index<Hash>::npos) ? std::begin(self.elems_) + position : std::end(self.elems_);
+			}
+		}
+		return self.bloomFilter_.may_contain(key) ? binary_find(self.elems_, key, CompareFirstAdapter<Comparator>()) : std::end(self.elems_);
+	}
+
+	auto find_elem(const Key& key) { return find_elem_impl(*this, key); }
+	auto find_elem(const Key& key) const { return find_elem_impl(*this, key); }
+
+	template<class Iter, class ElemsIt>
+	static auto find_projection(ElemsIt elemsLast)
+	{
+		return [elemsLast](ElemsIt it, const auto& key) { return Iter(impl::make_find_projection(elemsLast, CompareFirstAdapter<Comparator>())(it, key)); };
+	}
+
+	template<class Iter>
+	static auto bound_projection() { return [](auto it, const auto&) { return Iter(it); }; }
+
 private: // iterators implementation
 	class iterator_adapter_impl {
-		friend class assoc_vector<Key, T, Comparator, Allocator>;
+		friend class assoc_vector;
 		friend class const_iterator_adapter_impl;
 
 	public:
@@ -263,7 +509,7 @@ private: // iterators implementation
 	};
 
 	class const_iterator_adapter_impl {
-		friend class assoc_vector<Key, T, Comparator, Allocator>;
+		friend class assoc_vector;
 
 	public:
 		using iterator_category = std::random_access_iterator_tag;
@@ -293,7 +539,7 @@ private: // iterators implementation
 
 		difference_type operator-(const_iterator_adapter_impl other) const { return it_ - other.it_; }
 
-		reference operator*() const { return reference{ *it_ }; }
+		reference operator*() const { return *it_; }
 		pointer operator->() const { return &(*it_); }
 		reference operator[](difference_type n) const { return *(*this + n); }
 
@@ -311,7 +557,11 @@ private: // iterators implementation
 	};
 
 private:
+	static constexpr bool hashed = !std::is_void_v<Hash>;
+
 	container_type elems_;
+	std::conditional_t<hashed, hash_index<Hash>, no_hash_index> hashIndex_;
+	bloom_filter_for_t<Comparator> bloomFilter_;
 };
 
 #endif // !ASSOC_VECTOR_HPP
\ No newline at end of file
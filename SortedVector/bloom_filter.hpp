@@ -0,0 +1,144 @@
+#pragma once
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+
+// blocked Bloom filter: all bits of key are in one cache line sized block
+template<class Hash>
+class blocked_bloom_filter {
+	static constexpr std::size_t words_per_block = 8;
+	static constexpr std::size_t bits_per_word = 64;
+	static constexpr std::size_t bits_per_key = 10;
+	static constexpr std::size_t hashes_count = 6;
+
+	// filter is sized for this count of keys at least
+	static constexpr std::size_t min_capacity = 64;
+
+	struct alignas(64) block {
+		std::uint64_t words[words_per_block] = {};
+	};
+
+	std::vector<block> blocks_;
+	std::size_t capacity_ = 0;
+	std::size_t added_ = 0;
+	std::size_t removed_ = 0;
+	Hash hasher_;
+
+public:
+	// false means key is definitely absent
+	template<class K>
+	bool may_contain(const K& key) const
+	{
+		if (added_ == 0) {
+			return false;
+		}
+
+		const auto hash = mix(static_cast<std::uint64_t>(hasher_(key)));
+		const auto& currBlock = blocks_[block_index(hash)];
+		for (std::size_t i = 0; i < hashes_count; ++i) {
+			const auto bit = bit_index(hash, i);
+			if ((currBlock.words[bit / bits_per_word] & (std::uint64_t{ 1 } << (bit % bits_per_word))) == 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// returns false if filter is full and has to be rebuilt
+	template<class K>
+	bool add(const K& key)
+	{
+		if (added_ >= capacity_) {
+			return false;
+		}
+
+		const auto hash = mix(static_cast<std::uint64_t>(hasher_(key)));
+		auto& currBlock = blocks_[block_index(hash)];
+		for (std::size_t i = 0; i < hashes_count; ++i) {
+			const auto bit = bit_index(hash, i);
+			currBlock.words[bit / bits_per_word] |= std::uint64_t{ 1 } << (bit % bits_per_word);
+		}
+		++added_;
+		return true;
+	}
+
+	// bits of removed keys stay set, returns true if filter has to be rebuilt because of them
+	bool remove()
+	{
+		++removed_;
+		return removed_ * 2 > added_;
+	}
+
+	// sizes filter for twice more keys than in [first, last) and adds them all
+	template<class It, class KeyOf>
+	void rebuild(It first, It last, KeyOf keyOf)
+	{
+		const auto count = static_cast<std::size_t>(std::distance(first, last));
+		capacity_ = std::max(min_capacity, count * 2);
+		blocks_.assign((capacity_ * bits_per_key + words_per_block * bits_per_word - 1) / (words_per_block * bits_per_word), block{});
+		added_ = 0;
+		removed_ = 0;
+
+		for (; first != last; ++first) {
+			add(keyOf(*first));
+		}
+	}
+
+private:
+	static std::uint64_t mix(std::uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	std::size_t block_index(std::uint64_t hash) const { return static_cast<std::size_t>(hash % blocks_.size()); }
+	static std::size_t bit_index(std::uint64_t hash, std::size_t i) { return static_cast<std::size_t>(hash >> (i * 9 + 10)) & (words_per_block * bits_per_word - 1); }
+};
+
+// placeholder of blocked_bloom_filter for comparators without bloom_hash
+struct no_bloom_filter {
+	template<class K>
+	bool may_contain(const K&) const { return true; }
+
+	template<class K>
+	bool add(const K&) { return true; }
+
+	bool remove() { return false; }
+
+	template<class It, class KeyOf>
+	void rebuild(It, It, KeyOf) {}
+};
+
+
+// comparator with attached hash, containers keep Bloom filter of keys for such comparators,
+// keys equivalent by Comp must have equal hashes
+template<class Comp, class Hash>
+struct bloom_filtered : Comp {
+	using bloom_hash = Hash;
+	using Comp::Comp;
+};
+
+template<class Comp, class = void>
+struct bloom_hash_of { using type = void; };
+
+template<class Comp>
+struct bloom_hash_of<Comp, std::void_t<typename Comp::bloom_hash>> { using type = typename Comp::bloom_hash; };
+
+template<class Comp>
+using bloom_filter_for_t = std::conditional_t<
+	std::is_void_v<typename bloom_hash_of<Comp>::type>,
+	no_bloom_filter,
+	blocked_bloom_filter<typename bloom_hash_of<Comp>::type>>;
+
+#endif // !BLOOM_FILTER_HPP
@@ -0,0 +1,361 @@
+#pragma once
+#ifndef EXTERNAL_BUILDER_HPP
+#define EXTERNAL_BUILDER_HPP
+
+#include "assoc_vector.hpp"
+#include "key_value_pair_adapters.hpp"
+#include "algorithms_utils.hpp"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+
+
+// writes key and value as raw bytes
+template<class Key, class T>
+struct binary_serializer {
+	static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<T>, "binary_serializer requires trivially copyable key and value");
+
+	static void write(std::ostream& os, const std::pair<Key, T>& value)
+	{
+		os.write(reinterpret_cast<const char*>(&value.first), sizeof(Key));
+		os.write(reinterpret_cast<const char*>(&value.second), sizeof(T));
+	}
+
+	// false at the end of stream, throws on truncated record
+	static bool read(std::istream& is, std::pair<Key, T>& value)
+	{
+		is.read(reinterpret_cast<char*>(&value.first), sizeof(Key));
+		if (is.gcount() == 0 && is.eof()) {
+			return false;
+		}
+
+		is.read(reinterpret_cast<char*>(&value.second), sizeof(T));
+		if (!is) {
+			throw std::runtime_error{ "truncated record in run file" };
+		}
+		return true;
+	}
+};
+
+
+// builds sorted, deduplicated key-value sequence from input larger than memory:
+// batches are sorted into runs spilled to temporary files, runs are k-way merged at the end
+template<
+	class Key,
+	class T,
+	class Comparator = std::less<Key>,
+	class Serializer = binary_serializer<Key, T>
+>
+class external_assoc_builder {
+public:
+	using value_type = std::pair<Key, T>;
+	using size_type = std::size_t;
+
+	// count of runs merged at once, more runs are merged in several passes
+	static constexpr size_type max_merge_fan_in = 64;
+
+	explicit external_assoc_builder(size_type maxElementsInMemory, std::filesystem::path tempDirectory = std::filesystem::temp_directory_path())
+		: maxElementsInMemory_{ std::max<size_type>(1, maxElementsInMemory) }
+		, tempDirectory_{ std::move(tempDirectory) }
+	{
+		buffer_.reserve(maxElementsInMemory_);
+	}
+
+	external_assoc_builder(const external_assoc_builder&) = delete;
+	external_assoc_builder& operator=(const external_assoc_builder&) = delete;
+
+	~external_assoc_builder() { remove_runs(runs_); }
+
+	void push(value_type value)
+	{
+		buffer_.push_back(std::move(value));
+		if (buffer_.size() >= maxElementsInMemory_) {
+			spill();
+		}
+	}
+
+	template<class It>
+	void push(It first, It last)
+	{
+		for (; first != last; ++first) {
+			push(*first);
+		}
+	}
+
+	// calls sink(value_type&&) for every element in sorted order, of elements with equivalent keys only the first pushed one is kept
+	template<class Sink>
+	void merge(Sink sink)
+	{
+		if (runs_.empty()) {
+			sort_unique_buffer();
+			for (auto& value : buffer_) {
+				sink(std::move(value));
+			}
+			buffer_.clear();
+			return;
+		}
+
+		spill();
+		while (runs_.size() > max_merge_fan_in) {
+			// merged runs keep order of their groups, they are also appended to runs_ before being written, so that destructor removes them if pass throws
+			const auto inputsCount = runs_.size();
+			std::vector<std::filesystem::path> mergedRuns;
+			for (size_type first = 0; first < inputsCount; ) {
+				const auto last = std::min(inputsCount, first + max_merge_fan_in);
+				const std::vector<std::filesystem::path> group(std::cbegin(runs_) + first, std::cbegin(runs_) + last);
+
+				mergedRuns.push_back(make_run_path());
+				runs_.push_back(mergedRuns.back());
+				std::ofstream os = open_output(mergedRuns.back());
+				merge_runs(group, [&os](value_type&& value) { Serializer::write(os, value); });
+				check_output(os, mergedRuns.back());
+				remove_runs(group);
+				first = last;
+			}
+			runs_ = std::move(mergedRuns);
+		}
+
+		merge_runs(runs_, sink);
+		remove_runs(runs_);
+		runs_.clear();
+	}
+
+	auto build() -> assoc_vector<Key, T, Comparator>
+	{
+		typename assoc_vector<Key, T, Comparator>::container_type result;
+		merge([&result](value_type&& value) { result.push_back(std::move(value)); });
+		return assoc_vector<Key, T, Comparator>(sorted_range, std::move(result));
+	}
+
+	// writes merged output with Serializer to file at path, with binary_serializer it can be searched in place by sorted_file_reader
+	void build_file(const std::filesystem::path& path)
+	{
+		std::ofstream os = open_output(path);
+		merge([&os](value_type&& value) { Serializer::write(os, value); });
+		check_output(os, path);
+	}
+
+private:
+	void sort_unique_buffer()
+	{
+		CompareFirstAdapter<Comparator> comp;
+		parallel_stable_sort(std::begin(buffer_), std::end(buffer_), comp);
+		buffer_.erase(std::unique(std::begin(buffer_), std::end(buffer_), [comp](const value_type& left, const value_type& right) { return !comp(left, right); }), std::end(buffer_));
+	}
+
+	void spill()
+	{
+		if (buffer_.empty()) {
+			return;
+		}
+
+		sort_unique_buffer();
+		runs_.push_back(make_run_path());
+		std::ofstream os = open_output(runs_.back());
+		for (const auto& value : buffer_) {
+			Serializer::write(os, value);
+		}
+		check_output(os, runs_.back());
+		buffer_.clear();
+	}
+
+	template<class Sink>
+	static void merge_runs(const std::vector<std::filesystem::path>& runs, Sink&& sink)
+	{
+		struct head {
+			value_type value;
+			size_type run = 0;
+		};
+
+		// runs are ordered by push order, so on equal keys the head of the earlier run goes first
+		const auto greater = [comp = CompareFirstAdapter<Comparator>()](const head& left, const head& right) {
+			if (comp(left.value, right.value)) return false;
+			if (comp(right.value, left.value)) return true;
+			return left.run > right.run;
+		};
+
+		std::vector<std::ifstream> inputs;
+		inputs.reserve(runs.size());
+		std::vector<head> heads;
+		heads.reserve(runs.size());
+		for (size_type run = 0; run < runs.size(); ++run) {
+			inputs.emplace_back(runs[run], std::ios::binary);
+			head curr{ value_type{}, run };
+			if (read_run(inputs.back(), runs[run], curr.value)) {
+				heads.push_back(std::move(curr));
+			}
+		}
+		std::make_heap(std::begin(heads), std::end(heads), greater);
+
+		CompareFirstAdapter<Comparator> comp;
+		std::optional<Key> lastKey;
+		while (!heads.empty()) {
+			std::pop_heap(std::begin(heads), std::end(heads), greater);
+			auto& curr = heads.back();
+
+			if (!lastKey || comp(*lastKey, curr.value.first)) {
+				lastKey = curr.value.first;
+				sink(std::move(curr.value));
+			}
+
+			if (read_run(inputs[curr.run], runs[curr.run], curr.value)) {
+				std::push_heap(std::begin(heads), std::end(heads), greater);
+			}
+			else {
+				heads.pop_back();
+			}
+		}
+	}
+
+	std::filesystem::path make_run_path()
+	{
+		std::random_device rd;
+		return tempDirectory_ / ("assoc_run_" + std::to_string(rd()) + "_" + std::to_string(runsCreated_++) + ".tmp");
+	}
+
+	static std::ofstream open_output(const std::filesystem::path& path)
+	{
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		if (!os) {
+			throw std::runtime_error{ "unable to open file: " + path.string() };
+		}
+		return os;
+	}
+
+	// false at the end of run, throws if reading failed for another reason
+	static bool read_run(std::ifstream& is, const std::filesystem::path& path, value_type& value)
+	{
+		if (!is.is_open()) {
+			throw std::runtime_error{ "unable to open file: " + path.string() };
+		}
+		if (Serializer::read(is, value)) {
+			return true;
+		}
+		if (!is.eof()) {
+			throw std::runtime_error{ "unable to read file: " + path.string() };
+		}
+		return false;
+	}
+
+	// output is flushed so that errors of buffered writes are detected too
+	static void check_output(std::ofstream& os, const std::filesystem::path& path)
+	{
+		os.flush();
+		if (!os) {
+			throw std::runtime_error{ "unable to write file: " + path.string() };
+		}
+	}
+
+	static void remove_runs(const std::vector<std::filesystem::path>& runs)
+	{
+		std::error_code ec;
+		for (const auto& run : runs) {
+			std::filesystem::remove(run, ec);
+		}
+	}
+
+private:
+	size_type maxElementsInMemory_ = 0;
+	std::filesystem::path tempDirectory_;
+	std::vector<value_type> buffer_;
+	std::vector<std::filesystem::path> runs_;
+	size_type runsCreated_ = 0;
+};
+
+
+// searches file written by external_assoc_builder::build_file with binary_serializer without loading it:
+// records have fixed size, so record at any position is read by seeking to it
+template<
+	class Key,
+	class T,
+	class Comparator = std::less<Key>
+>
+class sorted_file_reader {
+public:
+	using value_type = std::pair<Key, T>;
+	using size_type = std::size_t;
+
+	static constexpr size_type record_size = sizeof(Key) + sizeof(T);
+
+	explicit sorted_file_reader(const std::filesystem::path& path)
+		: path_{ path }
+		, is_{ path, std::ios::binary }
+	{
+		if (!is_) {
+			throw std::runtime_error{ "unable to open file: " + path_.string() };
+		}
+
+		const auto bytes = std::filesystem::file_size(path_);
+		if (bytes % record_size != 0) {
+			throw std::runtime_error{ "truncated record in file: " + path_.string() };
+		}
+		size_ = static_cast<size_type>(bytes / record_size);
+	}
+
+	size_type size() const noexcept { return size_; }
+	bool empty() const noexcept { return size_ == 0; }
+
+	value_type at(size_type position)
+	{
+		if (position >= size_) {
+			throw std::out_of_range{ "sorted_file_reader::at" };
+		}
+
+		value_type value;
+		is_.seekg(static_cast<std::streamoff>(position * record_size));
+		if (!binary_serializer<Key, T>::read(is_, value)) {
+			throw std::runtime_error{ "unable to read file: " + path_.string() };
+		}
+		return value;
+	}
+
+	// position of the first record with key not less than key, size() if there is no such record
+	template<class K>
+	size_type lower_bound(const K& key)
+	{
+		size_type first = 0;
+		for (auto count = size_; count > 0; ) {
+			const auto half = count / 2;
+			if (comp_(at(first + half).first, key)) {
+				first += half + 1;
+				count -= half + 1;
+			}
+			else {
+				count = half;
+			}
+		}
+		return first;
+	}
+
+	template<class K>
+	std::optional<T> find(const K& key)
+	{
+		const auto position = lower_bound(key);
+		if (position == size_) {
+			return std::nullopt;
+		}
+
+		auto value = at(position);
+		if (comp_(key, value.first)) {
+			return std::nullopt;
+		}
+		return std::move(value.second);
+	}
+
+private:
+	std::filesystem::path path_;
+	std::ifstream is_;
+	size_type size_ = 0;
+	Comparator comp_;
+};
+
+#endif // !EXTERNAL_BUILDER_HPP
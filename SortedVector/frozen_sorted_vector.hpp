@@ -0,0 +1,219 @@
+#pragma once
+#ifndef FROZEN_SORTED_VECTOR_HPP
+#define FROZEN_SORTED_VECTOR_HPP
+
+#include "sorted_vector.hpp"
+#include "packed_index.hpp"
+#include "typelist_utils.hpp"
+#include "algorithms_utils.hpp"
+#include "bloom_filter.hpp"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+
+
+// read-only sorted_vector with indexes of comparators kept in packed_index:
+// every index takes about log2(size()) bits per element instead of sizeof(size_type) bytes
+template<class T, class Allocator, class... Comparators>
+class frozen_sorted_vector {
+public:
+	template<class CurrComp>
+	class const_iterator_impl;
+
+	using mutable_type = sorted_vector<T, Allocator, Comparators...>;
+	using inner_container_type = typename mutable_type::inner_container_type;
+
+	using value_type = typename inner_container_type::value_type;
+	using allocator_type = typename inner_container_type::allocator_type;
+	using size_type = typename inner_container_type::size_type;
+	using difference_type = typename inner_container_type::difference_type;
+
+	using const_reference = typename inner_container_type::const_reference;
+	using const_pointer = typename inner_container_type::const_pointer;
+
+	template<class CurrComp>
+	using const_iterator = const_iterator_impl<CurrComp>;
+
+	template<class CurrComp>
+	using const_reverse_iterator = std::reverse_iterator<const_iterator<CurrComp>>;
+
+private: // local traits
+	template<class Comp>
+	using contains_comp = std::enable_if_t<contains_v<Comp, Comparators...>>;
+
+	template<class Comp>
+	static constexpr auto index_of_comp = index_of_v<Comp, Comparators...>;
+
+	static constexpr auto count_comparators = sizeof...(Comparators);
+
+public:
+	frozen_sorted_vector() = default;
+
+	// takes elements and indexes of other, other is left empty
+	explicit frozen_sorted_vector(mutable_type&& other)
+	{
+		auto [elems, sortedIndexes] = other.extract();
+		elems_ = std::move(elems);
+		for (size_type i = 0; i < count_comparators; ++i) {
+			sortedIndexes_[i] = packed_index(sortedIndexes[i]);
+			std::vector<size_type>().swap(sortedIndexes[i]);
+		}
+		(rebuild_bloom_filter<Comparators>(), ...);
+	}
+
+	// unpacks indexes back to sorted_vector, leaving this container empty
+	auto thaw() -> mutable_type
+	{
+		std::vector<std::vector<size_type>> sortedIndexes(count_comparators);
+		for (size_type i = 0; i < count_comparators; ++i) {
+			sortedIndexes[i] = std::exchange(sortedIndexes_[i], packed_index()).unpack();
+		}
+		return mutable_type(sorted_range, std::exchange(elems_, inner_container_type()), std::move(sortedIndexes));
+	}
+
+	size_type size() const { return elems_.size(); }
+	bool empty() const { return elems_.empty(); }
+
+	// bytes occupied by indexes of all comparators
+	size_type indexes_memory_usage() const
+	{
+		size_type result = 0;
+		for (const auto& indexes : sortedIndexes_) {
+			result += indexes.memory_usage();
+		}
+		return result;
+	}
+
+	// searches go over const_iterator<Comp>, which dereferences to elements, so keys of any type are compared with elements only
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto find(const VT& value) const -> const_iterator<Comp>
+	{
+		if (!std::get<index_of_comp<Comp>>(bloomFilters_).may_contain(value)) {
+			return cend<Comp>();
+		}
+		return binary_find(cbegin<Comp>(), cend<Comp>(), value, Comp());
+	}
+
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto findAll(const VT& value) const -> std::pair<const_iterator<Comp>, const_iterator<Comp>>
+	{
+		if (!std::get<index_of_comp<Comp>>(bloomFilters_).may_contain(value)) {
+			return std::make_pair(cend<Comp>(), cend<Comp>());
+		}
+
+		return binary_find_range(cbegin<Comp>(), cend<Comp>(), value, Comp());
+	}
+
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto lower_bound(const VT& value) const -> const_iterator<Comp> { return fast_lower_bound(cbegin<Comp>(), cend<Comp>(), value, Comp()); }
+
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto upper_bound(const VT& value) const -> const_iterator<Comp> { return fast_upper_bound(cbegin<Comp>(), cend<Comp>(), value, Comp()); }
+
+	template<class Comp, typename = contains_comp<Comp>>
+	const T& at(size_type index) const { return elems_.at(sortedIndexes_[index_of_comp<Comp>][checked_index(index)]); }
+
+	template<class Comp, typename = contains_comp<Comp>>
+	auto cbegin() const { return const_iterator<Comp>(elems_, std::cbegin(sortedIndexes_[index_of_comp<Comp>])); }
+
+	template<class Comp, typename = contains_comp<Comp>>
+	auto cend() const { return const_iterator<Comp>(elems_, std::cend(sortedIndexes_[index_of_comp<Comp>])); }
+
+	template<class Comp> auto begin() const { return cbegin<Comp>(); }
+	template<class Comp> auto end() const { return cend<Comp>(); }
+
+	template<class Comp>
+	auto crbegin() const -> const_reverse_iterator<Comp> { return const_reverse_iterator<Comp>(cend<Comp>()); }
+
+	template<class Comp>
+	auto crend() const -> const_reverse_iterator<Comp> { return const_reverse_iterator<Comp>(cbegin<Comp>()); }
+
+	template<class Comp> auto rbegin() const { return crbegin<Comp>(); }
+	template<class Comp> auto rend() const { return crend<Comp>(); }
+
+	void swap(frozen_sorted_vector& other)
+	{
+		std::swap(elems_, other.elems_);
+		std::swap(sortedIndexes_, other.sortedIndexes_);
+		std::swap(bloomFilters_, other.bloomFilters_);
+	}
+
+private:
+	template<class CurrComp>
+	void rebuild_bloom_filter() { std::get<index_of_comp<CurrComp>>(bloomFilters_).rebuild(std::cbegin(elems_), std::cend(elems_), [](const T& value) -> const T& { return value; }); }
+
+	size_type checked_index(size_type index) const
+	{
+		if (index >= size()) {
+			throw std::out_of_range{ "index is out of range" };
+		}
+		return index;
+	}
+
+public: // iterators
+	template<class CurrComp>
+	class const_iterator_impl {
+		friend class frozen_sorted_vector;
+	private:
+		explicit constexpr const_iterator_impl(const inner_container_type& elems, packed_index::const_iterator indexIt)
+			: pElems_{ &elems }, currIndexIt_{ indexIt } {}
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = typename frozen_sorted_vector::value_type;
+		using difference_type = typename frozen_sorted_vector::difference_type;
+		using pointer = typename frozen_sorted_vector::const_pointer;
+		using reference = typename frozen_sorted_vector::const_reference;
+
+	public:
+		explicit constexpr const_iterator_impl() = default;
+
+		constexpr const_iterator_impl& operator++() { ++currIndexIt_; return *this; }
+		constexpr const_iterator_impl operator++(int) { auto result = *this; ++(*this); return result; }
+
+		constexpr const_iterator_impl& operator--() { --currIndexIt_; return *this; }
+		constexpr const_iterator_impl operator--(int) { auto result = *this; --(*this); return result; }
+
+		constexpr const_iterator_impl& operator+=(difference_type shift) { currIndexIt_ += shift; return *this; }
+		constexpr const_iterator_impl operator+(difference_type shift) const { auto result = *this; result += shift; return result; }
+
+		constexpr const_iterator_impl& operator-=(difference_type shift) { currIndexIt_ -= shift; return *this; }
+		constexpr const_iterator_impl operator-(difference_type shift) const { auto result = *this; result -= shift; return result; }
+
+		constexpr difference_type operator-(const const_iterator_impl other) const { return currIndexIt_ - other.currIndexIt_; }
+
+		reference operator*() const { return (*pElems_)[*currIndexIt_]; }
+		pointer operator->() const { return &(*pElems_)[*currIndexIt_]; }
+		reference operator[](difference_type n) const { return *(*this + n); }
+
+		constexpr bool operator<(const_iterator_impl other) const { return currIndexIt_ < other.currIndexIt_; }
+		constexpr bool operator>(const_iterator_impl other) const { return currIndexIt_ > other.currIndexIt_; }
+
+		constexpr bool operator==(const_iterator_impl other) const { return currIndexIt_ == other.currIndexIt_; }
+		constexpr bool operator!=(const_iterator_impl other) const { return !(*this == other); }
+
+		constexpr bool operator<=(const_iterator_impl other) const { return !(*this > other); }
+		constexpr bool operator>=(const_iterator_impl other) const { return !(*this < other); }
+
+	private:
+		const inner_container_type* pElems_ = nullptr;
+		packed_index::const_iterator currIndexIt_;
+	};
+
+private:
+	inner_container_type elems_;
+	std::array<packed_index, count_comparators> sortedIndexes_;
+	std::tuple<bloom_filter_for_t<Comparators>...> bloomFilters_;
+};
+
+template<class T, class... Comparators>
+using FrozenSortedCollection = frozen_sorted_vector<T, std::allocator<T>, Comparators...>;
+
+#endif // !FROZEN_SORTED_VECTOR_HPP
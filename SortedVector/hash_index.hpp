@@ -0,0 +1,126 @@
+#pragma once
+#ifndef HASH_INDEX_HPP
+#define HASH_INDEX_HPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+
+// open addressing (linear probing) table mapping key hashes to positions in external sorted array
+template<class Hash>
+class hash_index {
+public:
+	static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+private:
+	struct slot {
+		std::size_t hash = 0;
+		std::size_t position = npos;
+	};
+
+	// slots count is kept power of 2 and at least twice larger than count of positions
+	static constexpr std::size_t min_slots_count = 16;
+
+	// index is rebuilt after count / rebuild_lookups_ratio lookups done without it
+	static constexpr std::size_t rebuild_lookups_ratio = 16;
+
+	std::vector<slot> slots_;
+	std::size_t size_ = 0;
+	bool valid_ = true;
+	std::size_t staleLookups_ = 0;
+	Hash hasher_;
+
+public:
+	// position of element for which isKeyAt(position) is true among elements with hash of key, npos if there is no such element
+	template<class Key, class IsKeyAt>
+	std::size_t find(const Key& key, IsKeyAt isKeyAt) const
+	{
+		if (size_ == 0) {
+			return npos;
+		}
+
+		const auto hash = hasher_(key);
+		for (auto i = first_slot(hash); slots_[i].position != npos; i = next_slot(i)) {
+			if (slots_[i].hash == hash && isKeyAt(slots_[i].position)) {
+				return slots_[i].position;
+			}
+		}
+		return npos;
+	}
+
+	// positions of elements were shifted by insertion or erasure, index must be rebuilt before next find
+	void invalidate() { valid_ = false; }
+	bool valid() const { return valid_; }
+
+	// counts lookup done while index is invalid, true when such lookups have cost enough to pay for rebuilding index of count elements
+	bool stale_lookup(std::size_t count) { return ++staleLookups_ * rebuild_lookups_ratio >= count; }
+
+	// indexes keys of all elements in [first, last) by their positions
+	template<class It, class KeyOf>
+	void rebuild(It first, It last, KeyOf keyOf)
+	{
+		clear();
+		reserve(static_cast<std::size_t>(std::distance(first, last)));
+		for (; first != last; ++first, ++size_) {
+			emplace(hasher_(keyOf(*first)), size_);
+		}
+		valid_ = true;
+		staleLookups_ = 0;
+	}
+
+	void clear()
+	{
+		std::fill(std::begin(slots_), std::end(slots_), slot{});
+		size_ = 0;
+	}
+
+	void swap(hash_index& other)
+	{
+		std::swap(slots_, other.slots_);
+		std::swap(size_, other.size_);
+		std::swap(valid_, other.valid_);
+		std::swap(staleLookups_, other.staleLookups_);
+		std::swap(hasher_, other.hasher_);
+	}
+
+private:
+	std::size_t mask() const { return slots_.size() - 1; }
+	std::size_t first_slot(std::size_t hash) const { return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> 32) & mask(); }
+	std::size_t next_slot(std::size_t i) const { return (i + 1) & mask(); }
+
+	void emplace(std::size_t hash, std::size_t position)
+	{
+		auto i = first_slot(hash);
+		while (slots_[i].position != npos) {
+			i = next_slot(i);
+		}
+		slots_[i] = slot{ hash, position };
+	}
+
+	void reserve(std::size_t count)
+	{
+		if (count * 2 <= slots_.size()) {
+			return;
+		}
+
+		std::size_t slotsCount = min_slots_count;
+		while (slotsCount < count * 2) {
+			slotsCount *= 2;
+		}
+
+		auto oldSlots = std::exchange(slots_, std::vector<slot>(slotsCount));
+		for (const auto& s : oldSlots) {
+			if (s.position != npos) emplace(s.hash, s.position);
+		}
+	}
+};
+
+// placeholder of hash_index for containers without hash index
+struct no_hash_index {};
+
+#endif // !HASH_INDEX_HPP
@@ -4,13 +4,14 @@
 
 #include <utility>
 #include <iterator>
+#include <type_traits>
 
 
 template<class Comp>
 struct CompareFirstAdapter {
 	explicit CompareFirstAdapter() = default;
 
-	template<class... Args>
+	template<class... Args, typename = std::enable_if_t<std::is_constructible_v<Comp, Args&&...>>>
 	explicit CompareFirstAdapter(Args&&... args) : comp_{ std::forward<Args>(args)... } {}
 
 	template<class First>
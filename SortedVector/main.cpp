@@ -1,14 +1,23 @@
-//#include "sorted_vector.hpp"
-//#include "typelist_utils.hpp"
-//#include "registry.hpp"
+#include "sorted_vector.hpp"
+#include "typelist_utils.hpp"
+#include "registry.hpp"
 #include "assoc_vector.hpp"
+#include "bloom_filter.hpp"
+#include "workload_trace.hpp"
 
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <random>
 #include <iterator>
 #include <map>
 #include <string>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <cstdlib>
+#include <exception>
 
 struct Vector {
 	Vector(int x, int y, int z) : x{x}, y{y}, z{z} {}
@@ -45,7 +54,154 @@ struct CompareByZ {
 	bool operator()(int left, const Vector& right) const { return left < right.z; }
 };
 
-int main()
+// replays trace on subject and oracle, reports first divergence and time of both on timingTrace
+template<class Subject, class Oracle>
+bool check_subject(const char* name, const workload_trace& trace, const workload_trace& timingTrace)
+{
+	Subject subject;
+	Oracle oracle;
+	const auto divergence = find_divergence(trace, subject, oracle);
+	if (divergence != trace.size()) {
+		const auto& entry = trace.entries()[divergence];
+		std::cout << name << ": FAILED at operation " << divergence << " ("
+			<< static_cast<char>(entry.op) << ' ' << entry.key << ' ' << entry.value << ')' << std::endl;
+		return false;
+	}
+
+	Subject timedSubject;
+	Oracle timedOracle;
+	const auto subjectTime = time_replay(timingTrace, timedSubject);
+	const auto oracleTime = time_replay(timingTrace, timedOracle);
+	std::cout << name << ": ok, " << subjectTime.count() / 1000 << " us (oracle " << oracleTime.count() / 1000 << " us)" << std::endl;
+	return true;
+}
+
+// insert, emplace and emplace_hint of present key must leave present element unchanged and report that nothing was inserted
+bool check_assoc_vector_unique_keys()
+{
+	assoc_vector<int, std::string> assocVec{ { 1, "one" }, { 3, "three" } };
+
+	auto [insertedIt, inserted] = assocVec.insert({ 1, "uno" });
+	auto [emplacedIt, emplaced] = assocVec.emplace(3, "tres");
+	auto hintedIt = assocVec.emplace_hint(std::as_const(assocVec).find(3), 3, "drei");
+	auto hintedAfterIt = assocVec.emplace_hint(assocVec.cend(), 3, "trois");
+
+	const bool result = !inserted && insertedIt == assocVec.find(1) &&
+		!emplaced && emplacedIt == assocVec.find(3) &&
+		hintedIt == assocVec.find(3) && hintedAfterIt == assocVec.find(3) &&
+		assocVec.size() == 2 && assocVec.at(1) == "one" && assocVec.at(3) == "three";
+	std::cout << "assoc_vector unique keys: " << (result ? "ok" : "FAILED") << std::endl;
+	return result;
+}
+
+// bulk loads of elems through constructors and assign() must keep the first of equivalent keys, as emplace() into std::map does
+template<class AssocVector, class Map>
+bool bulk_loads_match(const typename AssocVector::container_type& elems)
+{
+	Map oracle;
+	for (const auto& elem : elems) {
+		oracle.emplace(elem);
+	}
+
+	const auto matches = [&oracle](const AssocVector& assocVec) {
+		return assocVec.size() == oracle.size() && std::equal(std::cbegin(oracle), std::cend(oracle), std::cbegin(assocVec),
+			[](const auto& expected, const auto& actual) { return expected.first == actual.first && expected.second == actual.second; });
+	};
+
+	AssocVector assigned;
+	assigned.assign(std::cbegin(elems), std::cend(elems));
+	AssocVector movedAssigned;
+	movedAssigned.assign(typename AssocVector::container_type(elems));
+
+	return matches(AssocVector(std::cbegin(elems), std::cend(elems))) && matches(AssocVector(typename AssocVector::container_type(elems))) &&
+		matches(assigned) && matches(movedAssigned);
+}
+
+// sizes are above thresholds of radix sorts and of parallel_stable_sort, which is used for comparators other than std::less
+bool check_assoc_vector_bulk_loads()
+{
+	constexpr std::size_t count = std::size_t{ 1 } << 17;
+	std::mt19937_64 rng(count);
+
+	std::vector<std::pair<std::int64_t, std::int64_t>> intElems;
+	std::vector<std::pair<std::string, std::int64_t>> stringElems;
+	for (std::size_t i = 0; i < count; ++i) {
+		const auto key = static_cast<std::int64_t>(rng() % (count / 2)) - static_cast<std::int64_t>(count / 4);
+		intElems.emplace_back(key, static_cast<std::int64_t>(i));
+		stringElems.emplace_back(std::to_string(key), static_cast<std::int64_t>(i));
+	}
+
+	// thread count is explicit, so that chunks are merged in parallel even on single core
+	const auto byKey = [](const auto& left, const auto& right) { return left.first > right.first; };
+	auto parallelSorted = intElems;
+	auto stableSorted = intElems;
+	parallel_stable_sort(std::begin(parallelSorted), std::end(parallelSorted), byKey, 4);
+	std::stable_sort(std::begin(stableSorted), std::end(stableSorted), byKey);
+
+	const bool result = parallelSorted == stableSorted &&
+		bulk_loads_match<assoc_vector<std::int64_t, std::int64_t>, std::map<std::int64_t, std::int64_t>>(intElems) &&
+		bulk_loads_match<assoc_vector<std::string, std::int64_t>, std::map<std::string, std::int64_t>>(stringElems) &&
+		bulk_loads_match<assoc_vector<std::int64_t, std::int64_t, std::greater<std::int64_t>>, std::map<std::int64_t, std::int64_t, std::greater<std::int64_t>>>(intElems);
+	std::cout << "assoc_vector bulk loads: " << (result ? "ok" : "FAILED") << std::endl;
+	return result;
+}
+
+// every container mode is checked against standard container under trace and timed under timingTrace
+bool check_all(const workload_trace& trace, const workload_trace& timingTrace)
+{
+	using key_type = std::int64_t;
+	using hashed_assoc_vector = assoc_vector<key_type, key_type, std::less<key_type>, std::allocator<std::pair<key_type, key_type>>, std::hash<key_type>>;
+	using filtered_less = bloom_filtered<std::less<key_type>, std::hash<key_type>>;
+
+	bool result = check_assoc_vector_unique_keys();
+	result &= check_assoc_vector_bulk_loads();
+	result &= check_subject<assoc_vector_subject<assoc_vector<key_type, key_type>>, std_map_subject>("assoc_vector", trace, timingTrace);
+	result &= check_subject<assoc_vector_subject<hashed_assoc_vector>, std_map_subject>("assoc_vector with hash index", trace, timingTrace);
+	result &= check_subject<assoc_vector_subject<assoc_vector<key_type, key_type, filtered_less>>, std_map_subject>("assoc_vector with Bloom filter", trace, timingTrace);
+	result &= check_subject<sorted_vector_subject<SortedCollection<key_type, std::less<key_type>>, std::less<key_type>>, std_multiset_subject>("sorted_vector", trace, timingTrace);
+	result &= check_subject<sorted_vector_subject<SortedCollection<key_type, filtered_less>, filtered_less>, std_multiset_subject>("sorted_vector with Bloom filter", trace, timingTrace);
+	result &= check_subject<runtime_index_subject<SortedCollection<key_type, std::greater<key_type>, std::less<key_type>>, std::less<key_type>, 1>, std_multiset_subject>("sorted_vector with runtime index", trace, timingTrace);
+	result &= check_subject<frozen_sorted_vector_subject<FrozenSortedCollection<key_type, std::less<key_type>>, std::less<key_type>>, std_multiset_subject>("frozen_sorted_vector", trace, timingTrace);
+	result &= check_subject<frozen_sorted_vector_subject<FrozenSortedCollection<key_type, filtered_less>, filtered_less>, std_multiset_subject>("frozen_sorted_vector with Bloom filter", trace, timingTrace);
+	result &= check_subject<registry_subject<registry<key_type>>, std_unordered_map_subject>("registry", trace, timingTrace);
+	result &= check_subject<registry_subject<registry<key_type, paged_storage<key_type>>>, std_unordered_map_subject>("registry with paged storage", trace, timingTrace);
+	result &= check_subject<registry_subject<slot_registry<key_type>>, std_unordered_map_subject>("slot_registry", trace, timingTrace);
+	result &= check_subject<registry_subject<components_registry_adapter>, std_unordered_map_subject>("components_registry", trace, timingTrace);
+	return result;
+}
+
+// usage:
+//   SortedVector record <file> [count] [seed]	- saves generated trace to file
+//   SortedVector replay <file>					- checks containers on trace from file
+//   SortedVector [count] [seed]				- checks containers on generated trace, times them on generated trace without clears
+int run_harness(int argc, char* argv[])
+{
+	const std::string command = (argc > 1) ? argv[1] : "";
+	if (command == "replay" && argc > 2) {
+		std::ifstream is(argv[2]);
+		if (!is) {
+			std::cout << "unable to open file: " << argv[2] << std::endl;
+			return EXIT_FAILURE;
+		}
+		const auto trace = workload_trace::load(is);
+		return check_all(trace, trace) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	const int firstArg = (command == "record") ? 3 : 1;
+	const std::size_t count = (argc > firstArg) ? std::stoul(argv[firstArg]) : 100000;
+	const std::uint64_t seed = (argc > firstArg + 1) ? std::stoull(argv[firstArg + 1]) : 1;
+	const auto keysCount = static_cast<std::int64_t>(count / 4 + 1);
+	const auto trace = workload_trace::generate(count, seed, keysCount);
+
+	if (command == "record" && argc > 2) {
+		std::ofstream os(argv[2]);
+		trace.save(os);
+		return os ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	return check_all(trace, workload_trace::generate(count, seed, keysCount, growing_mix())) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[])
 {
 	assoc_vector<std::string, int> assocVec;
 	assocVec["pen"] = 8;
@@ -60,7 +216,6 @@ int main()
 		std::cout << "Key: " << keyValue.first << ", Value: " << keyValue.second << std::endl;
 	}
 
-#if 0
 	SortedCollection<Vector, CompareByX, CompareByY, CompareByZ> sortedVec;
 	sortedVec.reserve(5);
 
@@ -109,12 +264,10 @@ int main()
 	std::cout << "Sorted by X in reverse:" << std::endl;
 	std::copy(sortedVec.rbegin<CompareByX>(), sortedVec.rend<CompareByX>(), std::ostream_iterator<Vector>(std::cout, ",\n"));
 	std::cout << std::endl;
-#endif
 
-#if 0
 	registry<std::string> reg;
-	const auto apple_id = reg.append("apple");
-	const auto pen_id = reg.append("pen");
+	reg.append("apple");
+	reg.append("pen");
 	const auto apple_pen_id = reg.append("apple-pen");
 
 	const auto printLine = [](const std::string& str) { std::cout << '\"' << str << '\"' << std::endl; };
@@ -127,8 +280,12 @@ int main()
 	std::cout << "reg after erasing \"apple-pen\": " << std::endl;
 	reg.for_each(printLine);
 	std::cout << std::endl;
-#endif
 
-	system("pause");
-	return 0;
+	try {
+		return run_harness(argc, argv);
+	}
+	catch (const std::exception& e) {
+		std::cout << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
 }
\ No newline at end of file
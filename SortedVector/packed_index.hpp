@@ -0,0 +1,181 @@
+#pragma once
+#ifndef PACKED_INDEX_HPP
+#define PACKED_INDEX_HPP
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+
+// immutable sequence of positions, bit-packed in blocks:
+// every block keeps its minimal value as anchor and stores offsets from it with the least bits count enough for the block
+class packed_index {
+	static constexpr std::size_t block_size = 128;
+	static constexpr std::size_t word_bits = 64;
+
+	struct block_header {
+		std::size_t anchor = 0;
+		std::size_t bitOffset = 0;
+		std::uint32_t width = 0;
+	};
+
+public:
+	class const_iterator;
+
+	packed_index() = default;
+
+	// packs [first, last) in single pass: every block is written right after its minimum and maximum are found, while it is in cache
+	template<class RandomIt>
+	packed_index(RandomIt first, RandomIt last) : size_{ static_cast<std::size_t>(last - first) }
+	{
+		blocks_.reserve((size_ + block_size - 1) / block_size);
+		// enough when values are positions below size_, as for indexes of containers; other values make words_ grow
+		words_.reserve((size_ * bits_count(size_) + word_bits - 1) / word_bits);
+
+		std::size_t bitsCount = 0;
+		for (std::size_t blockFirst = 0; blockFirst < size_; blockFirst += block_size) {
+			const auto blockLast = std::min(size_, blockFirst + block_size);
+			const auto [minIt, maxIt] = std::minmax_element(first + blockFirst, first + blockLast);
+
+			const block_header header{ static_cast<std::size_t>(*minIt), bitsCount, bits_count(static_cast<std::size_t>(*maxIt) - static_cast<std::size_t>(*minIt)) };
+			bitsCount += header.width * (blockLast - blockFirst);
+			words_.resize((bitsCount + word_bits - 1) / word_bits, 0);
+			for (auto i = blockFirst; i < blockLast; ++i) {
+				write(header, i - blockFirst, static_cast<std::size_t>(first[i]));
+			}
+			blocks_.push_back(header);
+		}
+	}
+
+	explicit packed_index(const std::vector<std::size_t>& values) : packed_index(std::cbegin(values), std::cend(values)) {}
+
+	std::size_t operator[](std::size_t i) const
+	{
+		assert(i < size_);
+		const auto& header = blocks_[i / block_size];
+		if (header.width == 0) {
+			return header.anchor;
+		}
+
+		const auto bit = header.bitOffset + header.width * (i % block_size);
+		const auto shift = bit % word_bits;
+		auto bits = words_[bit / word_bits] >> shift;
+		if (shift + header.width > word_bits) {
+			bits |= words_[bit / word_bits + 1] << (word_bits - shift);
+		}
+		return header.anchor + static_cast<std::size_t>(bits & mask(header.width));
+	}
+
+	std::size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	// bytes occupied by packed values and block headers
+	std::size_t memory_usage() const { return words_.size() * sizeof(std::uint64_t) + blocks_.size() * sizeof(block_header); }
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	auto unpack() const -> std::vector<std::size_t>
+	{
+		std::vector<std::size_t> result(size_);
+		for (std::size_t i = 0; i < size_; ++i) {
+			result[i] = (*this)[i];
+		}
+		return result;
+	}
+
+	void swap(packed_index& other)
+	{
+		std::swap(words_, other.words_);
+		std::swap(blocks_, other.blocks_);
+		std::swap(size_, other.size_);
+	}
+
+private:
+	static std::uint32_t bits_count(std::size_t value)
+	{
+		std::uint32_t result = 0;
+		for (; value != 0; value >>= 1) {
+			++result;
+		}
+		return result;
+	}
+
+	static std::uint64_t mask(std::uint32_t width) { return (width == word_bits) ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << width) - 1; }
+
+	void write(const block_header& header, std::size_t offset, std::size_t value)
+	{
+		if (header.width == 0) {
+			return;
+		}
+
+		const auto bits = static_cast<std::uint64_t>(value - header.anchor);
+		const auto bit = header.bitOffset + header.width * offset;
+		const auto shift = bit % word_bits;
+		words_[bit / word_bits] |= bits << shift;
+		if (shift + header.width > word_bits) {
+			words_[bit / word_bits + 1] |= bits >> (word_bits - shift);
+		}
+	}
+
+private:
+	std::vector<std::uint64_t> words_;
+	std::vector<block_header> blocks_;
+	std::size_t size_ = 0;
+};
+
+// random access iterator over unpacked values
+class packed_index::const_iterator {
+	friend class packed_index;
+
+	constexpr const_iterator(const packed_index* pIndex, std::size_t pos) : pIndex_{ pIndex }, pos_{ pos } {}
+
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using pointer = void;
+	using reference = std::size_t;
+
+	constexpr const_iterator() = default;
+
+	constexpr const_iterator& operator++() { ++pos_; return *this; }
+	constexpr const_iterator operator++(int) { auto result = *this; ++(*this); return result; }
+
+	constexpr const_iterator& operator--() { --pos_; return *this; }
+	constexpr const_iterator operator--(int) { auto result = *this; --(*this); return result; }
+
+	constexpr const_iterator& operator+=(difference_type shift) { pos_ += shift; return *this; }
+	constexpr const_iterator operator+(difference_type shift) const { auto result = *this; result += shift; return result; }
+
+	constexpr const_iterator& operator-=(difference_type shift) { pos_ -= shift; return *this; }
+	constexpr const_iterator operator-(difference_type shift) const { auto result = *this; result -= shift; return result; }
+
+	constexpr difference_type operator-(const const_iterator other) const { return static_cast<difference_type>(pos_) - static_cast<difference_type>(other.pos_); }
+
+	reference operator*() const { return (*pIndex_)[pos_]; }
+	reference operator[](difference_type n) const { return *(*this + n); }
+
+	constexpr bool operator<(const_iterator other) const { return pos_ < other.pos_; }
+	constexpr bool operator>(const_iterator other) const { return pos_ > other.pos_; }
+
+	constexpr bool operator==(const_iterator other) const { return pos_ == other.pos_; }
+	constexpr bool operator!=(const_iterator other) const { return !(*this == other); }
+
+	constexpr bool operator<=(const_iterator other) const { return !(*this > other); }
+	constexpr bool operator>=(const_iterator other) const { return !(*this < other); }
+
+	constexpr std::size_t position() const { return pos_; }
+
+private:
+	const packed_index* pIndex_ = nullptr;
+	std::size_t pos_ = 0;
+};
+
+inline auto packed_index::begin() const -> const_iterator { return const_iterator(this, 0); }
+inline auto packed_index::end() const -> const_iterator { return const_iterator(this, size_); }
+
+#endif // !PACKED_INDEX_HPP
@@ -2,62 +2,425 @@
 #ifndef REGISTRY_HPP
 #define REGISTRY_HPP
 
-#include "key_value_pair_adapters.hpp"
 #include "algorithms_utils.hpp"
+#include "typelist_utils.hpp"
 
 #include <vector>
 #include <utility>
 #include <optional>
+#include <thread>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <cassert>
 
 
+// entries are kept inside of registry's vector, moved during compaction;
+// released entries are left moved-from, liveness is recorded only by registry's occupancy bitmap
 template<class T>
+struct inline_storage {
+	using entry_type = T;
+
+	entry_type make(T element) { return element; }
+	void release(entry_type& entry) { [[maybe_unused]] T released = std::move(entry); }
+
+	static T* get(entry_type& entry) { return &entry; }
+	static const T* get(const entry_type& entry) { return &entry; }
+};
+
+// entries are allocated in fixed size pages, so their addresses are stable across compaction and growth
+template<class T, std::size_t PageSize = 1024>
+class paged_storage {
+	using slot_type = std::optional<T>;
+
+	std::vector<std::unique_ptr<slot_type[]>> pages_;
+	std::vector<slot_type*> freeSlots_;
+	std::size_t pageUsed_ = PageSize;
+
+public:
+	using entry_type = slot_type*;
+
+	entry_type make(T element) {
+		slot_type* slot = nullptr;
+		if (!freeSlots_.empty()) {
+			slot = freeSlots_.back();
+			freeSlots_.pop_back();
+		}
+		else {
+			if (pageUsed_ == PageSize) {
+				pages_.push_back(std::make_unique<slot_type[]>(PageSize));
+				pageUsed_ = 0;
+			}
+			slot = &pages_.back()[pageUsed_++];
+		}
+
+		slot->emplace(std::move(element));
+		return slot;
+	}
+
+	void release(entry_type& entry) {
+		entry->reset();
+		freeSlots_.push_back(entry);
+		entry = nullptr;
+	}
+
+	static T* get(entry_type entry) { return entry ? &(**entry) : nullptr; }
+};
+
+
+template<class T, class Storage = inline_storage<T>>
 class registry {
-	std::vector<std::pair<std::size_t, std::optional<T>>> elems_;
+	using entry_type = typename Storage::entry_type;
+
+	static constexpr std::size_t word_bits = 64;
+
+	// count of entries processed by pending compaction on every append/erase
+	static constexpr std::size_t compaction_step = 32;
+
+	std::vector<std::size_t> ids_;
+	std::vector<entry_type> entries_;
+	std::vector<std::uint64_t> occupancy_;
+	Storage storage_;
 	std::size_t size_ = 0;
 	std::size_t id_ = 0;
 
+	// pending compaction: [0, compactWrite_) is compacted, [compactWrite_, compactRead_) is dead
+	bool compacting_ = false;
+	std::size_t compactWrite_ = 0;
+	std::size_t compactRead_ = 0;
+
 public:
 	auto append(T element) -> std::size_t {
 		const std::size_t currID = id_;
-		elems_.emplace_back(currID, std::move(element));
+		const std::size_t index = std::size(ids_);
+		if (index % word_bits == 0) {
+			occupancy_.push_back(0);
+		}
+
+		ids_.push_back(currID);
+		entries_.push_back(storage_.make(std::move(element)));
+		set_occupied(index);
 		++size_;
 		++id_;
+		compact(compaction_step);
 		return currID;
 	}
 
 	void erase(std::size_t id) {
-		const auto p = std::lower_bound(std::begin(elems_), std::end(elems_), id, ComparePairByFirst<>());
-		if (p == std::end(elems_) || p->first != id) { return; }
+		const auto index = find_index(id);
+		if (index == std::size(ids_) || !occupied(index)) { return; }
 
-		p->second.reset();
+		storage_.release(entries_[index]);
+		reset_occupied(index);
 		--size_;
 
-		if (size_ < (std::size(elems_) / 2)) {
-			elems_.erase(std::remove_if(std::begin(elems_), std::end(elems_), [](const auto& e) { return !e.second; }), std::end(elems_));
+		if (size_ < (std::size(ids_) / 2)) {
+			start_compaction();
 		}
+		compact(compaction_step);
 	}
 
-	T* find(std::size_t id) {
-		const auto p = std::lower_bound(std::begin(elems_), std::end(elems_), id, ComparePairByFirst<>());
-		if (p == std::end(elems_) || p->first != id) { return nullptr; }
+	// starts compaction regardless of count of erased entries, it is run by append/erase and compact(budget) calls
+	void start_compaction() {
+		if (compacting_ || size_ == std::size(ids_)) { return; }
 
-		return &(*p->second);
+		compacting_ = true;
+		compactWrite_ = 0;
+		compactRead_ = 0;
+	}
+
+	bool compacting() const { return compacting_; }
+
+	// runs at most budget steps of pending compaction, returns true if nothing is left to compact
+	bool compact(std::size_t budget) {
+		if (!compacting_) { return true; }
+
+		for (; budget > 0 && compactRead_ < std::size(ids_); --budget, ++compactRead_) {
+			if (!occupied(compactRead_)) { continue; }
+
+			if (compactWrite_ != compactRead_) {
+				ids_[compactWrite_] = ids_[compactRead_];
+				entries_[compactWrite_] = std::move(entries_[compactRead_]);
+				set_occupied(compactWrite_);
+				reset_occupied(compactRead_);
+			}
+			++compactWrite_;
+		}
+
+		if (compactRead_ == std::size(ids_)) {
+			ids_.resize(compactWrite_);
+			entries_.erase(std::begin(entries_) + compactWrite_, std::end(entries_));
+			occupancy_.resize((compactWrite_ + word_bits - 1) / word_bits);
+			compacting_ = false;
+		}
+		return !compacting_;
+	}
+
+	T* find(std::size_t id) {
+		const auto index = find_index(id);
+		return (index != std::size(ids_) && occupied(index)) ? Storage::get(entries_[index]) : nullptr;
 	}
 
 	const T* find(std::size_t id) const {
-		const auto p = std::lower_bound(std::cbegin(elems_), std::cend(elems_), id, ComparePairByFirst<>());
-		if (p == std::cend(elems_) || p->first != id) { return nullptr; }
+		const auto index = find_index(id);
+		return (index != std::size(ids_) && occupied(index)) ? Storage::get(entries_[index]) : nullptr;
+	}
+
+	std::size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	template<class F>
+	void for_each(F f) { for_each_in_words(0, std::size(occupancy_), f); }
+
+	// f is called concurrently from threadsCount threads, each of them visits its own part of elements
+	template<class F>
+	void parallel_for_each(F f, std::size_t threadsCount = std::thread::hardware_concurrency()) {
+		parallel_chunks(std::size(occupancy_), threadsCount, [this, &f](std::size_t firstWord, std::size_t lastWord) {
+			for_each_in_words(firstWord, lastWord, f);
+		});
+	}
+
+private:
+	template<class F>
+	void for_each_in_words(std::size_t firstWord, std::size_t lastWord, F& f) {
+		for (; firstWord != lastWord; ++firstWord) {
+			for (auto bits = occupancy_[firstWord]; bits != 0; bits &= bits - 1) {
+				f(*Storage::get(entries_[firstWord * word_bits + count_trailing_zeros(bits)]));
+			}
+		}
+	}
+
+	bool occupied(std::size_t index) const { return (occupancy_[index / word_bits] >> (index % word_bits)) & 1; }
+	void set_occupied(std::size_t index) { occupancy_[index / word_bits] |= std::uint64_t{ 1 } << (index % word_bits); }
+	void reset_occupied(std::size_t index) { occupancy_[index / word_bits] &= ~(std::uint64_t{ 1 } << (index % word_bits)); }
+
+	std::size_t find_index(std::size_t id) const {
+		auto first = std::cbegin(ids_);
+		auto last = std::cend(ids_);
+		if (compacting_) {
+			// ids of not yet compacted entries are greater than ids of compacted ones
+			if (compactRead_ < std::size(ids_) && ids_[compactRead_] <= id) {
+				first += compactRead_;
+			}
+			else {
+				last = first + compactWrite_;
+			}
+		}
+
+		const auto p = fast_lower_bound(first, last, id);
+		return (p == last || *p != id) ? std::size(ids_) : static_cast<std::size_t>(p - std::cbegin(ids_));
+	}
+};
+
+struct registry_handle {
+	std::uint32_t index = 0;
+	std::uint32_t generation = 0;
+
+	friend bool operator==(registry_handle left, registry_handle right) { return left.index == right.index && left.generation == right.generation; }
+	friend bool operator!=(registry_handle left, registry_handle right) { return !(left == right); }
+};
+
+// maps generational handles to rows of dense arrays, rows are kept contiguous by moving the last row into erased one
+class slot_table {
+	static constexpr std::uint32_t no_slot = std::numeric_limits<std::uint32_t>::max();
+
+	struct slot {
+		std::uint32_t index = no_slot;		// row if slot is alive, next free slot otherwise
+		std::uint32_t generation = 0;		// odd if slot is alive
+	};
+
+	std::vector<slot> slots_;
+	std::vector<std::uint32_t> rowsSlots_;
+	std::uint32_t freeSlot_ = no_slot;
+
+public:
+	// handle of new row appended to the end
+	auto acquire() -> registry_handle {
+		std::uint32_t slotIndex = freeSlot_;
+		if (slotIndex == no_slot) {
+			slotIndex = static_cast<std::uint32_t>(std::size(slots_));
+			slots_.emplace_back();
+		}
+		else {
+			freeSlot_ = slots_[slotIndex].index;
+		}
+
+		auto& currSlot = slots_[slotIndex];
+		currSlot.index = static_cast<std::uint32_t>(std::size(rowsSlots_));
+		++currSlot.generation;
+
+		rowsSlots_.push_back(slotIndex);
+		return registry_handle{ slotIndex, currSlot.generation };
+	}
+
+	// returns row of erased handle, the caller moves the last row into it and pops the last row
+	auto release(registry_handle handle) -> std::size_t {
+		assert(contains(handle));
+
+		auto& currSlot = slots_[handle.index];
+		const auto row = currSlot.index;
+		if (row + 1 != std::size(rowsSlots_)) {
+			rowsSlots_[row] = rowsSlots_.back();
+			slots_[rowsSlots_[row]].index = row;
+		}
+		rowsSlots_.pop_back();
 
-		return &(*p->second);
+		++currSlot.generation;
+		currSlot.index = freeSlot_;
+		freeSlot_ = handle.index;
+		return row;
 	}
 
+	bool contains(registry_handle handle) const {
+		return (handle.generation & 1) != 0
+			&& handle.index < std::size(slots_)
+			&& slots_[handle.index].generation == handle.generation;
+	}
+
+	std::size_t row(registry_handle handle) const { assert(contains(handle)); return slots_[handle.index].index; }
+	std::size_t size() const { return std::size(rowsSlots_); }
+};
+
+// moves the last element of vec into the erased row
+template<class T>
+void erase_row(std::vector<T>& vec, std::size_t row)
+{
+	if (row + 1 != std::size(vec)) {
+		vec[row] = std::move(vec.back());
+	}
+	vec.pop_back();
+}
+
+
+// registry with O(1) append/find/erase: handles point to slots, slots point into dense values array
+template<class T>
+class slot_registry {
+	slot_table slots_;
+	std::vector<T> values_;
+
+public:
+	auto append(T element) -> registry_handle {
+		values_.push_back(std::move(element));
+		return slots_.acquire();
+	}
+
+	void erase(registry_handle handle) {
+		if (!contains(handle)) { return; }
+		erase_row(values_, slots_.release(handle));
+	}
+
+	bool contains(registry_handle handle) const { return slots_.contains(handle); }
+
+	T* find(registry_handle handle) { return contains(handle) ? &values_[slots_.row(handle)] : nullptr; }
+	const T* find(registry_handle handle) const { return contains(handle) ? &values_[slots_.row(handle)] : nullptr; }
+
+	std::size_t size() const { return std::size(values_); }
+	bool empty() const { return values_.empty(); }
+
 	template<class F>
 	void for_each(F f) {
-		for (const auto& e : elems_) {
-			if (e.second) f(*e.second);
+		for (auto& value : values_) {
+			f(value);
 		}
 	}
 };
 
+
+template<class T>
+struct column_span {
+	T* first = nullptr;
+	T* last = nullptr;
+
+	T* begin() const { return first; }
+	T* end() const { return last; }
+	T* data() const { return first; }
+
+	std::size_t size() const { return static_cast<std::size_t>(last - first); }
+	bool empty() const { return first == last; }
+
+	T& operator[](std::size_t index) const { return first[index]; }
+};
+
+// registry of several component types sharing one handle space, every component type is kept in its own contiguous column
+template<class... Ts>
+class components_registry {
+	static_assert(count_of_v<Ts...> > 0, "Component types are not provided");
+	static_assert(unique_types_v<Ts...>, "Component types must be distinct");
+
+	template<class U>
+	using contains_component = std::enable_if_t<contains_v<U, Ts...>>;
+
+	template<class U>
+	static constexpr auto index_of_component = index_of_v<U, Ts...>;
+
+	slot_table slots_;
+	std::tuple<std::vector<Ts>...> columns_;
+
+public:
+	auto append(Ts... components) -> registry_handle {
+		append_row(std::index_sequence_for<Ts...>(), std::move(components)...);
+		return slots_.acquire();
+	}
+
+	void erase(registry_handle handle) {
+		if (!contains(handle)) { return; }
+		erase_row(std::index_sequence_for<Ts...>(), slots_.release(handle));
+	}
+
+	bool contains(registry_handle handle) const { return slots_.contains(handle); }
+
+	template<class U, typename = contains_component<U>>
+	U* get(registry_handle handle) { return contains(handle) ? &std::get<index_of_component<U>>(columns_)[slots_.row(handle)] : nullptr; }
+
+	template<class U, typename = contains_component<U>>
+	const U* get(registry_handle handle) const { return contains(handle) ? &std::get<index_of_component<U>>(columns_)[slots_.row(handle)] : nullptr; }
+
+	template<class U, typename = contains_component<U>>
+	auto column() -> column_span<U> { return make_span(std::get<index_of_component<U>>(columns_)); }
+
+	template<class U, typename = contains_component<U>>
+	auto column() const -> column_span<const U> { return make_span(std::get<index_of_component<U>>(columns_)); }
+
+	template<std::size_t Index>
+	auto column() -> column_span<at_index_t<Index, Ts...>> { return make_span(std::get<Index>(columns_)); }
+
+	template<std::size_t Index>
+	auto column() const -> column_span<const at_index_t<Index, Ts...>> { return make_span(std::get<Index>(columns_)); }
+
+	std::size_t size() const { return slots_.size(); }
+	bool empty() const { return size() == 0; }
+
+	// f(Us&...) is called for every row, columns of Us are walked in lockstep
+	template<class... Us, class F>
+	void for_each(F f) {
+		static_assert((contains_v<Us, Ts...> && ...), "Unknown component type");
+
+		const auto walk = [this, &f](auto*... columnsData) {
+			for (std::size_t row = 0, rowsCount = size(); row != rowsCount; ++row) {
+				f(columnsData[row]...);
+			}
+		};
+		walk(std::get<index_of_component<Us>>(columns_).data()...);
+	}
+
+private:
+	template<std::size_t... Indexes>
+	void append_row(std::index_sequence<Indexes...>, Ts&&... components) {
+		(std::get<Indexes>(columns_).push_back(std::move(components)), ...);
+	}
+
+	template<std::size_t... Indexes>
+	void erase_row(std::index_sequence<Indexes...>, std::size_t row) {
+		(::erase_row(std::get<Indexes>(columns_), row), ...);
+	}
+
+	template<class U>
+	static auto make_span(std::vector<U>& column) { return column_span<U>{ column.data(), column.data() + std::size(column) }; }
+
+	template<class U>
+	static auto make_span(const std::vector<U>& column) { return column_span<const U>{ column.data(), column.data() + std::size(column) }; }
+};
+
 #endif // !REGISTRY_HPP
@@ -4,11 +4,19 @@
 
 #include "typelist_utils.hpp"
 #include "algorithms_utils.hpp"
+#include "bloom_filter.hpp"
 
 #include <vector>
 #include <algorithm>
 #include <cassert>
 #include <set>
+#include <stdexcept>
+#include <tuple>
+#include <limits>
+#include <utility>
+#include <numeric>
+#include <iterator>
+#include <type_traits>
 
 
 template<class T, class Allocator, class... Comparators>
@@ -35,6 +43,13 @@ struct sorted_vector {
 	template<class CurrComp>
 	using const_reverse_iterator = std::reverse_iterator<const_iterator<CurrComp>>;
 
+	// elements between two keys by comparator, iteration prefetches elements ahead
+	template<class CurrComp>
+	class range_view;
+
+	// iterator over comparator selected at runtime
+	using dynamic_const_iterator = const_iterator_impl<void>;
+
 private: // local traits
 	template<class Comp>
 	using contains_comp = std::enable_if_t<contains_v<Comp, Comparators...>>;
@@ -43,11 +58,23 @@ private: // local traits
 	static constexpr auto index_of_comp = index_of_v<Comp, Comparators...>;
 
 	static constexpr auto count_comparators = sizeof...(Comparators);
-	static_assert(count_comparators <= 0, "Comparators for type T are not provided");
+	static_assert(count_comparators > 0, "Comparators for type T are not provided");
 
 public:
 	explicit sorted_vector() : sortedIndexes_{ count_comparators } {}
 
+	// takes ownership of elems, indexes are built by sorting
+	explicit sorted_vector(inner_container_type&& elems) : elems_{ std::move(elems) }, sortedIndexes_{ count_comparators } { rebuild_sorted(); }
+
+	// takes ownership of elems and of indexes, sortedIndexes[i] must be positions of elems sorted by i-th comparator
+	sorted_vector(sorted_range_t, inner_container_type&& elems, std::vector<std::vector<size_type>>&& sortedIndexes)
+		: elems_{ std::move(elems) }, sortedIndexes_{ std::move(sortedIndexes) }
+	{
+		assert(sortedIndexes_.size() == count_comparators);
+		assert((std::is_sorted(std::cbegin(sortedIndexes_[index_of_comp<Comparators>]), std::cend(sortedIndexes_[index_of_comp<Comparators>]), ByIndexComparatorAdaptor<Comparators>(elems_)) && ...));
+		(rebuild_bloom_filter<Comparators>(), ...);
+	}
+
 	void insert(const T& val) { elems_.push_back(val); update_sorted(); }
 	void insert(T&& val) { elems_.push_back(std::move(val)); update_sorted(); }
 
@@ -71,29 +98,85 @@ public:
 				}
 			}
 		}
+		erased_from_bloom_filters();
 		return true;
 	}
-	bool eraseAll(const T& value)
+	bool eraseAll(const T& value) { return erase_if([&value](const T& elem) { return elem == value; }) != 0; }
+
+	// erases all elements for which pred(const T&) is true, elements and every index are compacted in single pass
+	template<class Pred>
+	size_type erase_if(Pred pred)
 	{
-		const auto indexes_to_erase = find_elements_indexes(value);
-		size_type shift = 0;
-		for (auto index_to_erase : indexes_to_erase) {
-			const auto currIndexToErase = index_to_erase - shift;
-			elems_.erase(std::cbegin(elems_) + currIndexToErase);
-
-			for (auto& sortedIndex : sortedIndexes_) {
-				sortedIndex.erase(std::find(std::cbegin(sortedIndex), std::cend(sortedIndex), currIndexToErase));
-				for (auto& index : sortedIndex) {
-					if (index > index_to_erase) {
-						--index;
-					}
-				}
+		constexpr auto erased = std::numeric_limits<size_type>::max();
+
+		std::vector<size_type> remap(elems_.size());
+		size_type write = 0;
+		for (size_type read = 0; read < elems_.size(); ++read) {
+			if (pred(std::as_const(elems_[read]))) {
+				remap[read] = erased;
+				continue;
 			}
 
-			++shift;
+			if (write != read) elems_[write] = std::move(elems_[read]);
+			remap[read] = write++;
+		}
+
+		const auto erasedCount = elems_.size() - write;
+		if (erasedCount == 0) {
+			return 0;
+		}
+
+		elems_.erase(std::cbegin(elems_) + write, std::cend(elems_));
+		for (auto& indexes : sortedIndexes_) {
+			auto indexWrite = std::begin(indexes);
+			for (const auto index : indexes) {
+				if (remap[index] != erased) *indexWrite++ = remap[index];
+			}
+			indexes.erase(indexWrite, std::end(indexes));
 		}
 
-		return (shift == 0);
+		(rebuild_bloom_filter<Comparators>(), ...);
+		return erasedCount;
+	}
+
+	// erases one element equal to every value of [first, last), as erase(const T&) called for each of them,
+	// returns count of erased elements
+	template<class InputIt, typename = enable_if_iterator<InputIt>>
+	size_type erase(InputIt first, InputIt last)
+	{
+		using first_comp = at_index_t<0, Comparators...>;
+
+		std::vector<T> values(first, last);
+		std::sort(std::begin(values), std::end(values), first_comp());
+
+		// elements are walked in order of positions, so as in erase(const T&) the first of equal elements goes first
+		std::vector<bool> used(values.size());
+		return erase_if([&values, &used](const T& elem) {
+			const auto range = fused_equal_range(std::cbegin(values), std::cend(values), elem, first_comp());
+			for (auto it = range.first; it != range.second; ++it) {
+				const auto i = static_cast<size_type>(it - std::cbegin(values));
+				if (!used[i] && *it == elem) {
+					used[i] = true;
+					return true;
+				}
+			}
+			return false;
+		});
+	}
+
+	// erases all elements equal to any of [first, last), as eraseAll(const T&) called for each of them,
+	// returns count of erased elements
+	template<class InputIt, typename = enable_if_iterator<InputIt>>
+	size_type eraseAll(InputIt first, InputIt last)
+	{
+		using first_comp = at_index_t<0, Comparators...>;
+
+		std::vector<T> values(first, last);
+		std::sort(std::begin(values), std::end(values), first_comp());
+		return erase_if([&values](const T& elem) {
+			const auto range = fused_equal_range(std::cbegin(values), std::cend(values), elem, first_comp());
+			return std::find(range.first, range.second, elem) != range.second;
+		});
 	}
 
 	void reserve(size_type space)
@@ -125,45 +208,248 @@ public:
 	bool empty() const { return elems_.empty(); }
 
 	template<class It>
-	void assign(It first, It last) { std::for_each(first, last, [this](const T& val) { insert(val); }); }
+	void assign(It first, It last)
+	{
+		elems_.assign(first, last);
+		rebuild_sorted();
+	}
 
 	template<class Cont>
-	void assign(const Cont& other) { assign(std::cbegin(other), std::cend(other)); }
+	void assign(Cont&& other)
+	{
+		if constexpr (std::is_same_v<std::decay_t<Cont>, inner_container_type> && !std::is_lvalue_reference_v<Cont>) {
+			elems_ = std::move(other);
+			rebuild_sorted();
+		}
+		else if constexpr (!std::is_lvalue_reference_v<Cont>) {
+			assign(std::make_move_iterator(std::begin(other)), std::make_move_iterator(std::end(other)));
+		}
+		else {
+			assign(std::cbegin(other), std::cend(other));
+		}
+	}
 
-	template<class Comp, typename VT, typename = contains_comp<Comp>>
-	auto find(const VT& value) const -> const_iterator<Comp>
+	void clear()
 	{
-		Comp comp;
-		const auto compareByValues = [this, comp](size_type leftIndex, const VT& value) {
-			return comp(elems_.at(leftIndex), value);
-		};
+		elems_.clear();
+		rebuild_sorted();
+	}
 
-		const auto& currSorted = sortedIndexes_.at(index_of_comp<Comp>);
+	// moves elements out (in insertion order), leaving container empty
+	auto release() -> inner_container_type
+	{
+		inner_container_type result = std::move(elems_);
+		clear();
+		return result;
+	}
 
-		const auto foundIndexIt = binary_find(currSorted, value, compareByValues);
-		const auto lastIndexIt = std::cend(currSorted);
+	// moves elements and indexes of every comparator out, leaving container empty
+	auto extract() -> std::pair<inner_container_type, std::vector<std::vector<size_type>>>
+	{
+		auto result = std::make_pair(std::move(elems_), std::move(sortedIndexes_));
+		sortedIndexes_.assign(count_comparators, {});
+		clear();
+		return result;
+	}
 
-		return (foundIndexIt != lastIndexIt)
-			? const_iterator<Comp>(elems_, foundIndexIt)
-			: const_iterator<Comp>(elems_, lastIndexIt);
+	// insertion of many elements spread over many step() calls, new container with elements of source and inserted ones
+	// is taken by result() when step() returns true; source is copied by first steps and must not be changed until then
+	class incremental_insert {
+	public:
+		incremental_insert(const sorted_vector& source, inner_container_type&& elems)
+			: pSource_{ &source }, sourceSize_{ source.size() }, insertedElems_{ std::move(elems) }, sortedIndexes_(count_comparators)
+		{
+			elems_.reserve(source.size() + insertedElems_.size());
+		}
+
+		// processes about budget elements, returns true if result is ready
+		bool step(size_type budget)
+		{
+			if (pSource_ != nullptr) {
+				copy_step(budget);
+				return false;
+			}
+
+			using step_function = bool(*)(incremental_insert&, size_type);
+			static constexpr step_function dispatch_table[] = { &incremental_insert::step_by<Comparators>... };
+			if (currComp_ < count_comparators && dispatch_table[currComp_](*this, budget)) {
+				++currComp_;
+			}
+			return done();
+		}
+
+		bool done() const { return pSource_ == nullptr && currComp_ == count_comparators; }
+
+		// built container, can be taken only when step() returned true
+		auto result() -> sorted_vector
+		{
+			assert(done());
+			return sorted_vector(sorted_range, std::move(elems_), std::move(sortedIndexes_));
+		}
+
+	private:
+		// copies elements of source, then inserted elements, then indexes of source
+		void copy_step(size_type budget)
+		{
+			const auto& sourceElems = pSource_->elems_;
+			auto count = std::min(budget, sourceElems.size() + insertedElems_.size() - elems_.size());
+			for (; count > 0 && elems_.size() < sourceElems.size(); --count, --budget) {
+				elems_.push_back(sourceElems[elems_.size()]);
+			}
+			for (; count > 0; --count, --budget) {
+				elems_.push_back(std::move(insertedElems_[elems_.size() - sourceElems.size()]));
+			}
+
+			for (; budget > 0 && copiedComp_ < count_comparators; ++copiedComp_) {
+				const auto& sourceIndexes = pSource_->sortedIndexes_[copiedComp_];
+				auto& indexes = sortedIndexes_[copiedComp_];
+				const auto copied = std::min(budget, sourceIndexes.size() - indexes.size());
+				indexes.insert(std::end(indexes), std::cbegin(sourceIndexes) + indexes.size(), std::cbegin(sourceIndexes) + indexes.size() + copied);
+				budget -= copied;
+				if (indexes.size() != sourceIndexes.size()) {
+					break;
+				}
+			}
+
+			if (copiedComp_ == count_comparators) {
+				insertedElems_ = inner_container_type();
+				start_comp();
+				pSource_ = nullptr;
+			}
+		}
+
+		// positions of inserted elements are sorted and then merged with index of source
+		template<class CurrComp>
+		static bool step_by(incremental_insert& self, size_type budget)
+		{
+			const ByIndexComparatorAdaptor<CurrComp> comp(self.elems_);
+			if (!self.sort_.done()) {
+				if (self.sort_.step(budget, comp)) {
+					self.merge_ = incremental_merge<size_type>(std::move(self.sortedIndexes_[self.currComp_]), self.sort_.release());
+				}
+				return false;
+			}
+
+			if (!self.merge_.step(budget, comp)) {
+				return false;
+			}
+
+			self.sortedIndexes_[self.currComp_] = self.merge_.release();
+			if (self.currComp_ + 1 < count_comparators) {
+				self.start_comp();
+			}
+			return true;
+		}
+
+		void start_comp()
+		{
+			std::vector<size_type> positions(elems_.size() - sourceSize_);
+			std::iota(std::begin(positions), std::end(positions), sourceSize_);
+			sort_ = incremental_sort<size_type>(std::move(positions));
+		}
+
+	private:
+		const sorted_vector* pSource_ = nullptr;
+		size_type sourceSize_ = 0;
+		inner_container_type insertedElems_;
+		inner_container_type elems_;
+		std::vector<std::vector<size_type>> sortedIndexes_;
+		size_type copiedComp_ = 0;
+		size_type currComp_ = 0;
+		incremental_sort<size_type> sort_;
+		incremental_merge<size_type> merge_;
+	};
+
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto find(const VT& value) const -> const_iterator<Comp>
+	{
+		if (!std::get<index_of_comp<Comp>>(bloomFilters_).may_contain(value)) {
+			return cend<Comp>();
+		}
+		return binary_find(cbegin<Comp>(), cend<Comp>(), value, Comp());
 	}
 
 	template<class Comp, typename VT, typename = contains_comp<Comp>>
 	auto findAll(const VT& value) const -> std::pair<const_iterator<Comp>, const_iterator<Comp>>
 	{
-		const auto foundLowerBound = find<Comp>(value);
-		if (foundLowerBound == cend<Comp>()) {
-			return std::make_pair(foundLowerBound, foundLowerBound);
+		if (!std::get<index_of_comp<Comp>>(bloomFilters_).may_contain(value)) {
+			return std::make_pair(cend<Comp>(), cend<Comp>());
 		}
 
-		const auto foundIndexIt = foundLowerBound.currIndexIt_;
-		return std::make_pair(
-			// first in range of equal elems
-			const_iterator<Comp>(elems_, foundIndexIt),
-			// last(going after the last) in range of equal elems
-			const_iterator<Comp>(elems_, std::upper_bound(foundIndexIt, std::cend(sortedIndexes_.at(index_of_comp<Comp>)), *foundIndexIt)));
+		return binary_find_range(cbegin<Comp>(), cend<Comp>(), value, Comp());
 	}
 
+	// batched find by Comp: iterator to every key from [first, last) (or cend<Comp>() if missing) is written to out
+	template<class Comp, class ForwardIt, class OutputIt, typename = contains_comp<Comp>>
+	OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const
+	{
+		return impl::interleaved_lower_bound(cbegin<Comp>(), cend<Comp>(), first, last, out, Comp(), impl::make_find_projection(cend<Comp>(), Comp()));
+	}
+	template<class Comp, class InputIt, class OutputIt, typename = contains_comp<Comp>>
+	OutputIt find_many(sorted_range_t, InputIt first, InputIt last, OutputIt out) const
+	{
+		return impl::galloping_lower_bound(cbegin<Comp>(), cend<Comp>(), first, last, out, Comp(), impl::make_find_projection(cend<Comp>(), Comp()));
+	}
+
+	template<class Comp, class ForwardIt, class OutputIt, typename = contains_comp<Comp>>
+	OutputIt lower_bound_many(ForwardIt first, ForwardIt last, OutputIt out) const
+	{
+		return impl::interleaved_lower_bound(cbegin<Comp>(), cend<Comp>(), first, last, out, Comp(), impl::make_identity_projection<const_iterator<Comp>>());
+	}
+	template<class Comp, class InputIt, class OutputIt, typename = contains_comp<Comp>>
+	OutputIt lower_bound_many(sorted_range_t, InputIt first, InputIt last, OutputIt out) const
+	{
+		return impl::galloping_lower_bound(cbegin<Comp>(), cend<Comp>(), first, last, out, Comp(), impl::make_identity_projection<const_iterator<Comp>>());
+	}
+
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto lower_bound(const VT& value) const -> const_iterator<Comp> { return fast_lower_bound(cbegin<Comp>(), cend<Comp>(), value, Comp()); }
+
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto upper_bound(const VT& value) const -> const_iterator<Comp> { return fast_upper_bound(cbegin<Comp>(), cend<Comp>(), value, Comp()); }
+
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto equal_range(const VT& value) const -> std::pair<const_iterator<Comp>, const_iterator<Comp>> { return fused_equal_range(cbegin<Comp>(), cend<Comp>(), value, Comp()); }
+
+	// elements in [lower, upper) by Comp
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto range(const VT& lower, const VT& upper) const -> range_view<Comp>
+	{
+		const auto first = fast_lower_bound(cbegin<Comp>(), cend<Comp>(), lower, Comp());
+		const auto last = fast_lower_bound(first, cend<Comp>(), upper, Comp());
+		return range_view<Comp>(elems_, first.currIndexIt_, std::max(first, last).currIndexIt_);
+	}
+
+	// elements in [lower, upper] by Comp
+	template<class Comp, typename VT, typename = contains_comp<Comp>>
+	auto closed_range(const VT& lower, const VT& upper) const -> range_view<Comp>
+	{
+		const auto first = fast_lower_bound(cbegin<Comp>(), cend<Comp>(), lower, Comp());
+		const auto last = fast_upper_bound(first, cend<Comp>(), upper, Comp());
+		return range_view<Comp>(elems_, first.currIndexIt_, std::max(first, last).currIndexIt_);
+	}
+
+	// runtime comparator selection: compIndex is position of comparator in Comparators...
+	template<typename VT>
+	auto find(size_type compIndex, const VT& value) const -> dynamic_const_iterator
+	{
+		using find_function = dynamic_const_iterator(*)(const sorted_vector&, const VT&);
+		static constexpr find_function dispatch_table[] = { &find_dispatched<Comparators, VT>... };
+		return dispatch_table[checked_comp_index(compIndex)](*this, value);
+	}
+
+	// elements in [lower, upper) by comparator at compIndex
+	template<typename VT>
+	auto range(size_type compIndex, const VT& lower, const VT& upper) const -> std::pair<dynamic_const_iterator, dynamic_const_iterator>
+	{
+		using range_function = std::pair<dynamic_const_iterator, dynamic_const_iterator>(*)(const sorted_vector&, const VT&, const VT&);
+		static constexpr range_function dispatch_table[] = { &range_dispatched<Comparators, VT>... };
+		return dispatch_table[checked_comp_index(compIndex)](*this, lower, upper);
+	}
+
+	auto cbegin(size_type compIndex) const { return dynamic_const_iterator(elems_, std::cbegin(sortedIndexes_.at(compIndex))); }
+	auto cend(size_type compIndex) const { return dynamic_const_iterator(elems_, std::cend(sortedIndexes_.at(compIndex))); }
+
 	template<class Comp, typename VT, typename = contains_comp<Comp>>
 	const T& at(size_type index) const { return elems_.at((sortedIndexes_.at(index_of_comp<Comp>)).at(index)); }
 
@@ -192,6 +478,7 @@ public:
 	{
 		std::swap(elems_, other.elems_);
 		std::swap(sortedIndexes_, other.sortedIndexes_);
+		std::swap(bloomFilters_, other.bloomFilters_);
 	}
 
 	template<class Comp, class It>
@@ -243,48 +530,98 @@ public:
 
 private:
 
+	// compares positions of elements by CompType, only for sorting and merging of indexes:
+	// searches by keys go over const_iterator<CompType>, so a key is never taken for a position
 	template<class CompType>
-	struct ByValueComparatorAdaptor {
-		explicit ByValueComparatorAdaptor(const inner_container_type& valuesContext)
+	struct ByIndexComparatorAdaptor {
+		explicit ByIndexComparatorAdaptor(const inner_container_type& valuesContext)
 			: pValuesContext_{ &valuesContext } {}
 
 		bool operator()(size_type left, size_type right) const { return comp_(pValuesContext_->at(left), pValuesContext_->at(right)); }
-		bool operator()(size_type left, const T& right) const { return comp_(pValuesContext_->at(left), right); }
-		bool operator()(const T& left, size_type right) const { return comp_(left, pValuesContext_->at(right)); }
 
 	private:
 		const inner_container_type* pValuesContext_ = nullptr;
 		CompType comp_;
 	};
 
+	// new element goes after its equivalents: every index keeps equivalent elements in ascending order of positions,
+	// the same order stable sort gives, so containers with equal elements have equal indexes however they were built
 	template<class CurrComp>
-	bool for_every_of()
+	void for_every_of()
 	{
 		const auto currElemIndex = elems_.size() - 1;
 		auto& currIndexes = sortedIndexes_.at(index_of_comp<CurrComp>);
-		currIndexes.insert(std::lower_bound(std::cbegin(currIndexes), std::cend(currIndexes), currElemIndex, ByValueComparatorAdaptor<CurrComp>(elems_)), currElemIndex);
+		currIndexes.insert(fast_upper_bound(std::cbegin(currIndexes), std::cend(currIndexes), currElemIndex, ByIndexComparatorAdaptor<CurrComp>(elems_)), currElemIndex);
 
-		return true;
+		if (!std::get<index_of_comp<CurrComp>>(bloomFilters_).add(elems_.back())) {
+			rebuild_bloom_filter<CurrComp>();
+		}
+	}
+
+	template<class CurrComp>
+	void rebuild_bloom_filter() { std::get<index_of_comp<CurrComp>>(bloomFilters_).rebuild(std::cbegin(elems_), std::cend(elems_), [](const T& value) -> const T& { return value; }); }
+
+	template<class CurrComp>
+	void erased_from_bloom_filter()
+	{
+		if (std::get<index_of_comp<CurrComp>>(bloomFilters_).remove()) {
+			rebuild_bloom_filter<CurrComp>();
+		}
+	}
+
+	void erased_from_bloom_filters() { (erased_from_bloom_filter<Comparators>(), ...); }
+
+	template<class CurrComp>
+	void rebuild_sorted_by()
+	{
+		auto& currIndexes = sortedIndexes_.at(index_of_comp<CurrComp>);
+		currIndexes.resize(elems_.size());
+		std::iota(std::begin(currIndexes), std::end(currIndexes), size_type{ 0 });
+		parallel_stable_sort(std::begin(currIndexes), std::end(currIndexes), ByIndexComparatorAdaptor<CurrComp>(elems_));
+		rebuild_bloom_filter<CurrComp>();
 	}
 
-	void update_sorted() { insert_to_sorted(elems_.back()); }
-	void insert_to_sorted(const T& value) { bool do_this[]{ for_every_of<Comparators>()... }; }
+	void rebuild_sorted() { (rebuild_sorted_by<Comparators>(), ...); }
+
+	void update_sorted() { (for_every_of<Comparators>(), ...); }
 
 	template<class CurrComp>
-	auto find_by(const T& value) -> std::pair<typename std::vector<size_type>::iterator, typename std::vector<size_type>::iterator>
+	auto find_by(const T& value) const -> std::pair<typename std::vector<size_type>::const_iterator, typename std::vector<size_type>::const_iterator>
 	{
-		return binary_find_range(sortedIndexes_.at(index_of_comp<CurrComp>), value, ByValueComparatorAdaptor<CurrComp>(elems_));
+		const auto foundRange = binary_find_range(cbegin<CurrComp>(), cend<CurrComp>(), value, CurrComp());
+		return std::make_pair(foundRange.first.currIndexIt_, foundRange.second.currIndexIt_);
+	}
+
+	static size_type checked_comp_index(size_type compIndex)
+	{
+		if (compIndex >= count_comparators) {
+			throw std::out_of_range{ "comparator index is out of range" };
+		}
+		return compIndex;
+	}
+
+	template<class Comp, typename VT>
+	static auto find_dispatched(const sorted_vector& self, const VT& value) -> dynamic_const_iterator
+	{
+		return dynamic_const_iterator(self.elems_, self.template find<Comp>(value).currIndexIt_);
+	}
+
+	template<class Comp, typename VT>
+	static auto range_dispatched(const sorted_vector& self, const VT& lower, const VT& upper) -> std::pair<dynamic_const_iterator, dynamic_const_iterator>
+	{
+		const auto [first, last] = self.template range<Comp>(lower, upper).bounds();
+		return std::make_pair(dynamic_const_iterator(self.elems_, first.currIndexIt_), dynamic_const_iterator(self.elems_, last.currIndexIt_));
 	}
 
 	auto find_elements_indexes(const T& value) -> std::set<size_type>
 	{
-		using iter_type = typename std::vector<size_type>::iterator;
+		using iter_type = typename std::vector<size_type>::const_iterator;
 		using iters_pair = std::pair<iter_type, iter_type>;
 
 		iters_pair pairs_arr[] = { find_by<Comparators>(value)... };
 
 		std::set<size_type> result;
-		for (const auto currIters : pairs_arr) {
+		for (const auto& currIters : pairs_arr) {
 			std::for_each(currIters.first, currIters.second, [&result](auto index) { result.emplace(index); });
 		}
 
@@ -292,7 +629,7 @@ private:
 		return result;
 	}
 
-private: // iterators
+public: // iterators
 	template<class CurrComp>
 	class const_iterator_impl {
 		friend class sorted_vector<T, Allocator, Comparators...>;
@@ -302,10 +639,10 @@ private: // iterators
 
 	public:
 		using iterator_category = std::random_access_iterator_tag;
-		using value_type = value_type;
-		using difference_type = difference_type;
-		using pointer = const_pointer;
-		using reference = const_reference;
+		using value_type = typename sorted_vector::value_type;
+		using difference_type = typename sorted_vector::difference_type;
+		using pointer = typename sorted_vector::const_pointer;
+		using reference = typename sorted_vector::const_reference;
 
 	public:
 		explicit constexpr const_iterator_impl() = default;
@@ -342,9 +679,83 @@ private: // iterators
 		typename std::vector<size_type>::const_iterator currIndexIt_;
 	};
 
+	template<class CurrComp>
+	class range_view {
+		friend class sorted_vector<T, Allocator, Comparators...>;
+
+		using index_iterator = typename std::vector<size_type>::const_iterator;
+
+		// count of index steps for which elements are prefetched ahead of current one
+		static constexpr difference_type prefetch_distance = 8;
+
+		constexpr range_view(const inner_container_type& elems, index_iterator first, index_iterator last)
+			: pElems_{ &elems }, first_{ first }, last_{ last } {}
+
+	public:
+		class iterator {
+			friend class range_view;
+
+			iterator(const inner_container_type& elems, index_iterator indexIt, index_iterator lastIndexIt)
+				: pElems_{ &elems }, currIndexIt_{ indexIt }, lastIndexIt_{ lastIndexIt }
+			{
+				for (auto it = currIndexIt_; it != lastIndexIt_ && it - currIndexIt_ < prefetch_distance; ++it) {
+					prefetch(pElems_->data() + *it);
+				}
+			}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = typename sorted_vector::value_type;
+			using difference_type = typename sorted_vector::difference_type;
+			using pointer = typename sorted_vector::const_pointer;
+			using reference = typename sorted_vector::const_reference;
+
+			iterator() = default;
+
+			iterator& operator++()
+			{
+				++currIndexIt_;
+				if (lastIndexIt_ - currIndexIt_ > prefetch_distance) {
+					prefetch(pElems_->data() + currIndexIt_[prefetch_distance]);
+				}
+				return *this;
+			}
+			iterator operator++(int) { auto result = *this; ++(*this); return result; }
+
+			reference operator*() const { return (*pElems_)[*currIndexIt_]; }
+			pointer operator->() const { return &(*pElems_)[*currIndexIt_]; }
+
+			bool operator==(const iterator& other) const { return currIndexIt_ == other.currIndexIt_; }
+			bool operator!=(const iterator& other) const { return !(*this == other); }
+
+		private:
+			const inner_container_type* pElems_ = nullptr;
+			index_iterator currIndexIt_;
+			index_iterator lastIndexIt_;
+		};
+
+		iterator begin() const { return iterator(*pElems_, first_, last_); }
+		iterator end() const { return iterator(*pElems_, last_, last_); }
+
+		size_type size() const { return static_cast<size_type>(last_ - first_); }
+		bool empty() const { return first_ == last_; }
+
+		// bounds of view as random access iterators of container
+		auto bounds() const -> std::pair<const_iterator<CurrComp>, const_iterator<CurrComp>>
+		{
+			return std::make_pair(const_iterator<CurrComp>(*pElems_, first_), const_iterator<CurrComp>(*pElems_, last_));
+		}
+
+	private:
+		const inner_container_type* pElems_ = nullptr;
+		index_iterator first_;
+		index_iterator last_;
+	};
+
 private:
 	inner_container_type elems_;
 	std::vector<std::vector<size_type>> sortedIndexes_;
+	std::tuple<bloom_filter_for_t<Comparators>...> bloomFilters_;
 };
 
 template<class T, class... Comparators>
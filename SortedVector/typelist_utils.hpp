@@ -3,6 +3,7 @@
 #define TYPELIST_UTILS_HPP
 
 #include <type_traits>
+#include <cstddef>
 
 namespace impl {
 
@@ -24,7 +25,7 @@ namespace impl {
 	struct index_of_impl<Head, Head, Tail...> : std::integral_constant<std::size_t, 0> {};
 
 	template <class Type, class Head, class... Tail>
-	struct index_of_impl<Type, Head, Tail...> : std::integral_constant<size_t, 1 + index_of_impl<Type, Tail...>::value> {};
+	struct index_of_impl<Type, Head, Tail...> : std::integral_constant<std::size_t, 1 + index_of_impl<Type, Tail...>::value> {};
 
 	// contains impl
 	template<class Type, class... TypesPack>
@@ -53,5 +54,13 @@ constexpr auto contains_v = impl::contains_impl<Type, TypesPack...>::value;
 template<class... TypesPack>
 constexpr auto count_of_v = sizeof...(TypesPack);
 
+// count of occurrences of type
+template<class Type, class... TypesPack>
+constexpr auto occurrences_of_v = (std::size_t{ 0 } + ... + std::size_t{ std::is_same_v<Type, TypesPack> });
+
+// every type occurs once
+template<class... TypesPack>
+constexpr bool unique_types_v = ((occurrences_of_v<TypesPack, TypesPack...> == 1) && ...);
+
 
 #endif // !TYPELIST_UTILS_HPP
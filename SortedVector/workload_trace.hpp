@@ -0,0 +1,911 @@
+#pragma once
+#ifndef WORKLOAD_TRACE_HPP
+#define WORKLOAD_TRACE_HPP
+
+#include "assoc_vector.hpp"
+#include "sorted_vector.hpp"
+#include "frozen_sorted_vector.hpp"
+#include "registry.hpp"
+#include "external_builder.hpp"
+
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <string>
+#include <random>
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+#include <atomic>
+
+
+// operations of trace, stored by their letters
+enum class trace_op : char {
+	insert = 'i',		// key, value
+	erase = 'e',		// key
+	find = 'f',			// key
+	range = 'r',		// count of keys in [key, value)
+	clear = 'c',
+	insert_range = 'n',	// every key in [key, value) with range_value(key)
+	erase_range = 'x',	// every key in [key, value)
+	find_batch = 'b'	// value keys from batch_keys(), found values and lower bounds are summed
+};
+
+inline bool is_trace_op(char op)
+{
+	for (const auto known : { 'i', 'e', 'f', 'r', 'c', 'n', 'x', 'b' }) {
+		if (op == known) return true;
+	}
+	return false;
+}
+
+struct trace_entry {
+	trace_op op = trace_op::find;
+	std::int64_t key = 0;
+	std::int64_t value = 0;
+};
+
+// result of operation on missing key
+constexpr std::int64_t trace_missing = -1;
+
+// budget of every step() call of incremental operations, small to make them resume many times
+constexpr std::size_t trace_step_budget = 7;
+
+// keys [key, value) of insert_range and erase_range entries
+inline std::vector<std::int64_t> range_keys(const trace_entry& entry)
+{
+	std::vector<std::int64_t> result;
+	for (auto key = entry.key; key < entry.value; ++key) {
+		result.push_back(key);
+	}
+	return result;
+}
+
+inline std::int64_t range_value(std::int64_t key) { return key * 2 + 1; }
+
+// keys of find_batch entry: value keys spread over [key, key + 3 * value) in not sorted order
+inline std::vector<std::int64_t> batch_keys(const trace_entry& entry)
+{
+	std::vector<std::int64_t> result(static_cast<std::size_t>(std::max<std::int64_t>(entry.value, 0)));
+	for (std::size_t i = 0; i < result.size(); ++i) {
+		result[i] = entry.key + static_cast<std::int64_t>((i * 5) % result.size()) * 3;
+	}
+	return result;
+}
+
+// batches of odd size are looked up through sorted_range overloads
+inline bool sorted_batch(const trace_entry& entry) { return entry.value % 2 != 0; }
+
+// result of find_batch does not depend on order of lookups
+inline std::int64_t batch_step(std::int64_t result, std::int64_t found, std::int64_t lowerBound)
+{
+	return static_cast<std::int64_t>(static_cast<std::uint64_t>(result) + static_cast<std::uint64_t>(found) * 31u + static_cast<std::uint64_t>(lowerBound));
+}
+
+
+// shares of operations in generated workload
+struct workload_mix {
+	unsigned insert = 36;
+	unsigned erase = 13;
+	unsigned find = 31;
+	unsigned range = 9;
+	unsigned clear = 1;
+	unsigned insertRange = 2;
+	unsigned eraseRange = 2;
+	unsigned findBatch = 6;
+};
+
+// default shares without clears: containers grow to about keysCount elements instead of staying small, for timing
+inline workload_mix growing_mix()
+{
+	workload_mix result;
+	result.clear = 0;
+	return result;
+}
+
+// sequence of operations, which can be saved as text (one "op key value" line per operation) and replayed on containers
+class workload_trace {
+public:
+	void record(trace_op op, std::int64_t key = 0, std::int64_t value = 0) { entries_.push_back(trace_entry{ op, key, value }); }
+
+	const std::vector<trace_entry>& entries() const { return entries_; }
+	std::size_t size() const { return entries_.size(); }
+
+	// random workload over keys in [0, keysCount), the same seed gives the same trace
+	static workload_trace generate(std::size_t count, std::uint64_t seed, std::int64_t keysCount, workload_mix mix = {})
+	{
+		std::mt19937_64 rng(seed);
+		const auto random_key = [&rng, keysCount]() { return static_cast<std::int64_t>(rng() % static_cast<std::uint64_t>(keysCount)); };
+		const unsigned total = mix.insert + mix.erase + mix.find + mix.range + mix.clear + mix.insertRange + mix.eraseRange + mix.findBatch;
+		const auto random_span = [&rng]() { return static_cast<std::int64_t>(rng() % 64); };
+
+		workload_trace result;
+		result.entries_.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			auto choice = static_cast<unsigned>(rng() % total);
+			if (choice < mix.insert) {
+				result.record(trace_op::insert, random_key(), static_cast<std::int64_t>(i));
+			}
+			else if ((choice -= mix.insert) < mix.erase) {
+				result.record(trace_op::erase, random_key());
+			}
+			else if ((choice -= mix.erase) < mix.find) {
+				result.record(trace_op::find, random_key());
+			}
+			else if ((choice -= mix.find) < mix.range) {
+				const auto lower = random_key();
+				result.record(trace_op::range, lower, lower + random_key() / 8);
+			}
+			else if ((choice -= mix.range) < mix.clear) {
+				result.record(trace_op::clear);
+			}
+			else if ((choice -= mix.clear) < mix.insertRange) {
+				const auto lower = random_key();
+				result.record(trace_op::insert_range, lower, lower + random_span());
+			}
+			else if ((choice -= mix.insertRange) < mix.eraseRange) {
+				const auto lower = random_key();
+				result.record(trace_op::erase_range, lower, lower + random_span());
+			}
+			else {
+				result.record(trace_op::find_batch, random_key(), 1 + random_span() / 4);
+			}
+		}
+		return result;
+	}
+
+	void save(std::ostream& os) const
+	{
+		for (const auto& entry : entries_) {
+			os << static_cast<char>(entry.op) << ' ' << entry.key << ' ' << entry.value << '\n';
+		}
+	}
+
+	static workload_trace load(std::istream& is)
+	{
+		workload_trace result;
+		char op = 0;
+		trace_entry entry;
+		while (is >> op >> entry.key >> entry.value) {
+			if (!is_trace_op(op)) {
+				throw std::runtime_error{ std::string("unknown trace operation: ") + op };
+			}
+			entry.op = static_cast<trace_op>(op);
+			result.entries_.push_back(entry);
+		}
+		return result;
+	}
+
+private:
+	std::vector<trace_entry> entries_;
+};
+
+
+// subjects apply trace entries to containers and return observable results of operations,
+// digest() summarizes state of container
+
+inline std::int64_t digest_step(std::int64_t digest, std::int64_t key, std::int64_t value)
+{
+	return static_cast<std::int64_t>(static_cast<std::uint64_t>(digest) * 1000003u + static_cast<std::uint64_t>(key) * 31u + static_cast<std::uint64_t>(value));
+}
+
+// insert_range goes by key modulo 5 through insert(first, last), incremental_assign, adopting constructor, assign() or external_assoc_builder,
+// erase_range goes through erase_if() for even keys and through erase of batch of keys for odd ones
+template<class AssocVector>
+class assoc_vector_subject {
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::insert: return cont_.emplace(entry.key, entry.value).second ? 1 : 0;
+		case trace_op::erase: {
+			const auto size = cont_.size();
+			cont_.erase(typename AssocVector::value_type(entry.key, 0));
+			return static_cast<std::int64_t>(size - cont_.size());
+		}
+		case trace_op::find: {
+			auto it = cont_.find(entry.key);
+			return (it != cont_.end()) ? (*it).second : trace_missing;
+		}
+		case trace_op::range: return (entry.key < entry.value) ? std::distance(cont_.lower_bound(entry.key), cont_.lower_bound(entry.value)) : 0;
+		case trace_op::clear: cont_.clear(); return 0;
+		case trace_op::insert_range: insert_range(entry); return static_cast<std::int64_t>(cont_.size());
+		case trace_op::erase_range: return static_cast<std::int64_t>(erase_range(entry));
+		case trace_op::find_batch: return find_batch(entry);
+		}
+		return trace_missing;
+	}
+
+	std::int64_t digest() const
+	{
+		std::int64_t result = 0;
+		for (const auto& keyValue : cont_) {
+			result = digest_step(result, keyValue.first, keyValue.second);
+		}
+		return result;
+	}
+
+private:
+	void insert_range(const trace_entry& entry)
+	{
+		std::vector<std::pair<std::int64_t, std::int64_t>> elems;
+		for (const auto key : range_keys(entry)) {
+			elems.emplace_back(key, range_value(key));
+		}
+
+		const auto variant = static_cast<std::uint64_t>(entry.key) % 5;
+		if (variant == 0) {
+			cont_.insert(std::cbegin(elems), std::cend(elems));
+			return;
+		}
+
+		// present elements go first, so they are kept over inserted ones with the same keys
+		auto allElems = cont_.release();
+		allElems.insert(std::end(allElems), std::cbegin(elems), std::cend(elems));
+		if (variant == 1) {
+			typename AssocVector::incremental_assign assign(std::move(allElems));
+			while (!assign.step(trace_step_budget)) {}
+			cont_ = assign.result();
+		}
+		else if (variant == 2) {
+			cont_ = AssocVector(std::move(allElems));
+		}
+		else if (variant == 3) {
+			cont_.assign(std::cbegin(allElems), std::cend(allElems));
+		}
+		else {
+			cont_ = build_external(allElems);
+		}
+	}
+
+	// memory limit makes count of runs exceed merge fan-in, so intermediate merge passes are done too
+	static AssocVector build_external(const typename AssocVector::container_type& elems)
+	{
+		using key_type = typename AssocVector::key_type;
+		using mapped_type = typename AssocVector::mapped_type;
+		using builder_type = external_assoc_builder<key_type, mapped_type, typename AssocVector::key_compare>;
+
+		builder_type builder(elems.size() / (builder_type::max_merge_fan_in + 1) + 1);
+		builder.push(std::cbegin(elems), std::cend(elems));
+
+		typename AssocVector::container_type result;
+		builder.merge([&result](std::pair<key_type, mapped_type>&& value) { result.push_back(std::move(value)); });
+		return AssocVector(sorted_range, std::move(result));
+	}
+
+	std::size_t erase_range(const trace_entry& entry)
+	{
+		if (entry.key % 2 == 0) {
+			return cont_.erase_if([&entry](const auto& elem) { return entry.key <= elem.first && elem.first < entry.value; });
+		}
+
+		const auto keys = range_keys(entry);
+		return cont_.erase(std::cbegin(keys), std::cend(keys));
+	}
+
+	std::int64_t find_batch(const trace_entry& entry)
+	{
+		auto keys = batch_keys(entry);
+		std::vector<typename AssocVector::iterator> found;
+		std::vector<typename AssocVector::iterator> bounds;
+		if (sorted_batch(entry)) {
+			std::sort(std::begin(keys), std::end(keys));
+			cont_.find_many(sorted_range, std::cbegin(keys), std::cend(keys), std::back_inserter(found));
+			cont_.lower_bound_many(sorted_range, std::cbegin(keys), std::cend(keys), std::back_inserter(bounds));
+		}
+		else {
+			cont_.find_many(std::cbegin(keys), std::cend(keys), std::back_inserter(found));
+			cont_.lower_bound_many(std::cbegin(keys), std::cend(keys), std::back_inserter(bounds));
+		}
+
+		std::int64_t result = 0;
+		for (std::size_t i = 0; i < keys.size(); ++i) {
+			result = batch_step(result, (found[i] != cont_.end()) ? (*found[i]).second : trace_missing, (bounds[i] != cont_.end()) ? (*bounds[i]).first : trace_missing);
+		}
+		return result;
+	}
+
+private:
+	AssocVector cont_;
+};
+
+class std_map_subject {
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::insert: return cont_.emplace(entry.key, entry.value).second ? 1 : 0;
+		case trace_op::erase: return static_cast<std::int64_t>(cont_.erase(entry.key));
+		case trace_op::find: {
+			const auto it = cont_.find(entry.key);
+			return (it != cont_.end()) ? it->second : trace_missing;
+		}
+		case trace_op::range: return (entry.key < entry.value) ? std::distance(cont_.lower_bound(entry.key), cont_.lower_bound(entry.value)) : 0;
+		case trace_op::clear: cont_.clear(); return 0;
+		case trace_op::insert_range: {
+			for (const auto key : range_keys(entry)) {
+				cont_.emplace(key, range_value(key));
+			}
+			return static_cast<std::int64_t>(cont_.size());
+		}
+		case trace_op::erase_range: {
+			if (entry.key >= entry.value) return 0;
+			const auto first = cont_.lower_bound(entry.key);
+			const auto last = cont_.lower_bound(entry.value);
+			const auto count = std::distance(first, last);
+			cont_.erase(first, last);
+			return count;
+		}
+		case trace_op::find_batch: {
+			std::int64_t result = 0;
+			for (const auto key : batch_keys(entry)) {
+				const auto it = cont_.find(key);
+				const auto bound = cont_.lower_bound(key);
+				result = batch_step(result, (it != cont_.end()) ? it->second : trace_missing, (bound != cont_.end()) ? bound->first : trace_missing);
+			}
+			return result;
+		}
+		}
+		return trace_missing;
+	}
+
+	std::int64_t digest() const
+	{
+		std::int64_t result = 0;
+		for (const auto& keyValue : cont_) {
+			result = digest_step(result, keyValue.first, keyValue.second);
+		}
+		return result;
+	}
+
+private:
+	std::map<std::int64_t, std::int64_t> cont_;
+};
+
+// keys are elements of SortedVector, Comp orders them as std::less;
+// find goes through equal_range() for even keys and through find() and findAll() for odd ones,
+// range counts size() of range() for even keys and iterates closed_range() for odd ones,
+// insert_range goes by key modulo 4 through insert(), incremental_insert, adopting constructor or assign(),
+// erase goes through erase() of single value for even keys and of batch of values for odd ones,
+// erase_range goes through erase_if() for even keys and through eraseAll() of batch of values for odd ones
+template<class SortedVector, class Comp>
+class sorted_vector_subject {
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::insert: cont_.insert(entry.key); return static_cast<std::int64_t>(cont_.size());
+		case trace_op::erase: return erase(entry);
+		case trace_op::find: return find(entry);
+		case trace_op::range: return range(entry);
+		case trace_op::clear: cont_.clear(); return 0;
+		case trace_op::insert_range: insert_range(entry); return static_cast<std::int64_t>(cont_.size());
+		case trace_op::erase_range: return static_cast<std::int64_t>(erase_range(entry));
+		case trace_op::find_batch: return find_batch(entry);
+		}
+		return trace_missing;
+	}
+
+	std::int64_t digest() const
+	{
+		std::int64_t result = 0;
+		for (auto it = cont_.template cbegin<Comp>(); it != cont_.template cend<Comp>(); ++it) {
+			result = digest_step(result, *it, 0);
+		}
+		return result;
+	}
+
+private:
+	// count of equal keys, find() must agree with findAll() about presence of key
+	std::int64_t find(const trace_entry& entry) const
+	{
+		if (entry.key % 2 == 0) {
+			const auto range = cont_.template equal_range<Comp>(entry.key);
+			return range.second - range.first;
+		}
+
+		const auto it = cont_.template find<Comp>(entry.key);
+		const auto range = cont_.template findAll<Comp>(entry.key);
+		if ((it == cont_.template cend<Comp>()) != (range.first == range.second) || (it != cont_.template cend<Comp>() && *it != entry.key)) {
+			return trace_missing;
+		}
+		return range.second - range.first;
+	}
+
+	// keys are integers, so [key, value) is the same as [key, value - 1]; iterated keys must be in it
+	std::int64_t range(const trace_entry& entry) const
+	{
+		if (entry.key % 2 == 0) {
+			return static_cast<std::int64_t>(cont_.template range<Comp>(entry.key, entry.value).size());
+		}
+
+		std::int64_t count = 0;
+		for (const auto key : cont_.template closed_range<Comp>(entry.key, entry.value - 1)) {
+			if (key < entry.key || key >= entry.value) {
+				return trace_missing;
+			}
+			++count;
+		}
+		return count;
+	}
+
+	void insert_range(const trace_entry& entry)
+	{
+		const auto keys = range_keys(entry);
+		const auto variant = static_cast<std::uint64_t>(entry.key) % 4;
+		if (variant == 0) {
+			for (const auto key : keys) {
+				cont_.insert(key);
+			}
+			return;
+		}
+
+		if (variant == 1) {
+			typename SortedVector::incremental_insert insert(cont_, typename SortedVector::inner_container_type(std::cbegin(keys), std::cend(keys)));
+			while (!insert.step(trace_step_budget)) {}
+			cont_ = insert.result();
+			return;
+		}
+
+		typename SortedVector::inner_container_type allKeys(cont_.template cbegin<Comp>(), cont_.template cend<Comp>());
+		allKeys.insert(std::end(allKeys), std::cbegin(keys), std::cend(keys));
+		if (variant == 2) {
+			cont_ = SortedVector(std::move(allKeys));
+		}
+		else {
+			cont_.assign(std::cbegin(allKeys), std::cend(allKeys));
+		}
+	}
+
+	std::int64_t erase(const trace_entry& entry)
+	{
+		if (entry.key % 2 == 0) {
+			return cont_.erase(entry.key) ? 1 : 0;
+		}
+		return static_cast<std::int64_t>(cont_.erase(&entry.key, &entry.key + 1));
+	}
+
+	std::size_t erase_range(const trace_entry& entry)
+	{
+		if (entry.key % 2 == 0) {
+			return cont_.erase_if([&entry](std::int64_t key) { return entry.key <= key && key < entry.value; });
+		}
+
+		const auto keys = range_keys(entry);
+		return cont_.eraseAll(std::cbegin(keys), std::cend(keys));
+	}
+
+	std::int64_t find_batch(const trace_entry& entry) const
+	{
+		using iterator = typename SortedVector::template const_iterator<Comp>;
+
+		auto keys = batch_keys(entry);
+		std::vector<iterator> found;
+		std::vector<iterator> bounds;
+		if (sorted_batch(entry)) {
+			std::sort(std::begin(keys), std::end(keys));
+			cont_.template find_many<Comp>(sorted_range, std::cbegin(keys), std::cend(keys), std::back_inserter(found));
+			cont_.template lower_bound_many<Comp>(sorted_range, std::cbegin(keys), std::cend(keys), std::back_inserter(bounds));
+		}
+		else {
+			cont_.template find_many<Comp>(std::cbegin(keys), std::cend(keys), std::back_inserter(found));
+			cont_.template lower_bound_many<Comp>(std::cbegin(keys), std::cend(keys), std::back_inserter(bounds));
+		}
+
+		const auto last = cont_.template cend<Comp>();
+		std::int64_t result = 0;
+		for (std::size_t i = 0; i < keys.size(); ++i) {
+			result = batch_step(result, (found[i] != last) ? *found[i] : trace_missing, (bounds[i] != last) ? *bounds[i] : trace_missing);
+		}
+		return result;
+	}
+
+protected:
+	SortedVector cont_;
+};
+
+// find and range go through runtime selection of comparator at CompIndex, which must be Comp
+template<class SortedVector, class Comp, std::size_t CompIndex>
+class runtime_index_subject : public sorted_vector_subject<SortedVector, Comp> {
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::find: {
+			std::int64_t count = 0;
+			for (auto it = this->cont_.find(CompIndex, entry.key); it != this->cont_.cend(CompIndex) && *it == entry.key; ++it) {
+				++count;
+			}
+			return count;
+		}
+		case trace_op::range: {
+			const auto [first, last] = this->cont_.range(CompIndex, entry.key, entry.value);
+			return last - first;
+		}
+		default: return sorted_vector_subject<SortedVector, Comp>::apply(entry);
+		}
+	}
+};
+
+// reads freeze container once reads done since the last thaw have paid for freezing, modifications thaw it back
+template<class Frozen, class Comp>
+class frozen_sorted_vector_subject : public sorted_vector_subject<typename Frozen::mutable_type, Comp> {
+	using base = sorted_vector_subject<typename Frozen::mutable_type, Comp>;
+
+	static constexpr std::size_t freeze_reads_ratio = 16;
+
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::find:
+		case trace_op::range:
+		case trace_op::find_batch:
+			if (!frozen_ && ++thawedReads_ * freeze_reads_ratio < this->cont_.size()) {
+				return base::apply(entry);
+			}
+			freeze();
+			return apply_frozen(entry);
+		default:
+			thaw();
+			return base::apply(entry);
+		}
+	}
+
+	std::int64_t digest() const
+	{
+		if (!frozen_) {
+			return base::digest();
+		}
+
+		std::int64_t result = 0;
+		for (auto it = frozenCont_.template cbegin<Comp>(); it != frozenCont_.template cend<Comp>(); ++it) {
+			result = digest_step(result, *it, 0);
+		}
+		return result;
+	}
+
+private:
+	std::int64_t apply_frozen(const trace_entry& entry) const
+	{
+		switch (entry.op) {
+		case trace_op::find: {
+			const auto range = frozenCont_.template findAll<Comp>(entry.key);
+			return range.second - range.first;
+		}
+		case trace_op::range: return (entry.key < entry.value) ? frozenCont_.template lower_bound<Comp>(entry.value) - frozenCont_.template lower_bound<Comp>(entry.key) : 0;
+		case trace_op::find_batch: {
+			const auto last = frozenCont_.template cend<Comp>();
+			std::int64_t result = 0;
+			for (const auto key : batch_keys(entry)) {
+				const auto it = frozenCont_.template find<Comp>(key);
+				const auto bound = frozenCont_.template lower_bound<Comp>(key);
+				result = batch_step(result, (it != last) ? *it : trace_missing, (bound != last) ? *bound : trace_missing);
+			}
+			return result;
+		}
+		default: return trace_missing;
+		}
+	}
+
+	void freeze()
+	{
+		if (!frozen_) {
+			frozenCont_ = Frozen(std::move(this->cont_));
+			frozen_ = true;
+			thawedReads_ = 0;
+		}
+	}
+
+	void thaw()
+	{
+		if (frozen_) {
+			this->cont_ = frozenCont_.thaw();
+			frozen_ = false;
+		}
+	}
+
+private:
+	Frozen frozenCont_;
+	bool frozen_ = false;
+	std::size_t thawedReads_ = 0;
+};
+
+class std_multiset_subject {
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::insert: cont_.insert(entry.key); return static_cast<std::int64_t>(cont_.size());
+		case trace_op::erase: {
+			const auto it = cont_.find(entry.key);
+			if (it == cont_.end()) return 0;
+			cont_.erase(it);
+			return 1;
+		}
+		case trace_op::find: return static_cast<std::int64_t>(cont_.count(entry.key));
+		case trace_op::range: return (entry.key < entry.value) ? std::distance(cont_.lower_bound(entry.key), cont_.lower_bound(entry.value)) : 0;
+		case trace_op::clear: cont_.clear(); return 0;
+		case trace_op::insert_range: {
+			for (const auto key : range_keys(entry)) {
+				cont_.insert(key);
+			}
+			return static_cast<std::int64_t>(cont_.size());
+		}
+		case trace_op::erase_range: {
+			if (entry.key >= entry.value) return 0;
+			const auto first = cont_.lower_bound(entry.key);
+			const auto last = cont_.lower_bound(entry.value);
+			const auto count = std::distance(first, last);
+			cont_.erase(first, last);
+			return count;
+		}
+		case trace_op::find_batch: {
+			std::int64_t result = 0;
+			for (const auto key : batch_keys(entry)) {
+				const auto bound = cont_.lower_bound(key);
+				const auto found = (bound != cont_.end() && *bound == key);
+				result = batch_step(result, found ? key : trace_missing, (bound != cont_.end()) ? *bound : trace_missing);
+			}
+			return result;
+		}
+		}
+		return trace_missing;
+	}
+
+	std::int64_t digest() const
+	{
+		std::int64_t result = 0;
+		for (const auto key : cont_) {
+			result = digest_step(result, key, 0);
+		}
+		return result;
+	}
+
+private:
+	std::multiset<std::int64_t> cont_;
+};
+
+namespace impl {
+
+	template<class Registry, class = void>
+	struct has_compaction : std::false_type {};
+
+	template<class Registry>
+	struct has_compaction<Registry, std::void_t<decltype(std::declval<Registry&>().start_compaction())>> : std::true_type {};
+
+	template<class Registry, class = void>
+	struct has_parallel_for_each : std::false_type {};
+
+	template<class Registry>
+	struct has_parallel_for_each<Registry, std::void_t<decltype(std::declval<Registry&>().parallel_for_each(std::declval<void (*)(std::int64_t)>()))>> : std::true_type {};
+}
+
+// components_registry of value and its check component, presented as registry of values;
+// value of row with check not matching it is reported as missing
+class components_registry_adapter {
+public:
+	auto append(std::int64_t value) -> registry_handle { return cont_.append(value, check_of(value)); }
+	void erase(registry_handle handle) { cont_.erase(handle); }
+	std::size_t size() const { return cont_.size(); }
+
+	const std::int64_t* find(registry_handle handle) const
+	{
+		const auto pValue = cont_.get<std::int64_t>(handle);
+		const auto pCheck = cont_.get<std::uint32_t>(handle);
+		return (pValue != nullptr && pCheck != nullptr && *pCheck == check_of(*pValue)) ? pValue : nullptr;
+	}
+
+	template<class F>
+	void for_each(F f)
+	{
+		cont_.for_each<std::int64_t, std::uint32_t>([&f](std::int64_t value, std::uint32_t check) { f((check == check_of(value)) ? value : trace_missing); });
+	}
+
+private:
+	static std::uint32_t check_of(std::int64_t value) { return static_cast<std::uint32_t>(static_cast<std::uint64_t>(value) * 2654435761u); }
+
+private:
+	components_registry<std::int64_t, std::uint32_t> cont_;
+};
+
+// keys of trace are ordinals of appended values, range is size and clear is full compaction
+template<class Registry>
+class registry_subject {
+	using handle_type = decltype(std::declval<Registry&>().append(std::int64_t{}));
+
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::insert: handles_.push_back(cont_.append(entry.value)); return static_cast<std::int64_t>(handles_.size()) - 1;
+		case trace_op::erase: return erase(entry.key);
+		case trace_op::find: return find(entry.key);
+		case trace_op::range: return static_cast<std::int64_t>(cont_.size());
+		case trace_op::clear: compact(); return static_cast<std::int64_t>(cont_.size());
+		case trace_op::insert_range: {
+			for (const auto key : range_keys(entry)) {
+				handles_.push_back(cont_.append(range_value(key)));
+			}
+			return static_cast<std::int64_t>(handles_.size());
+		}
+		case trace_op::erase_range: {
+			std::int64_t count = 0;
+			for (const auto key : range_keys(entry)) {
+				count += erase(key);
+			}
+			return count;
+		}
+		case trace_op::find_batch: {
+			std::int64_t result = 0;
+			for (const auto key : batch_keys(entry)) {
+				result = batch_step(result, find(key), 0);
+			}
+			return result;
+		}
+		}
+		return trace_missing;
+	}
+
+	// order of values in registry is not specified, so digest is sum which does not depend on it; registries with parallel_for_each() are summed concurrently
+	std::int64_t digest()
+	{
+		if constexpr (impl::has_parallel_for_each<Registry>::value) {
+			std::atomic<std::int64_t> result{ 0 };
+			cont_.parallel_for_each([&result](std::int64_t value) { result.fetch_add(value * 31 + 1, std::memory_order_relaxed); });
+			return result.load();
+		}
+		else {
+			std::int64_t result = 0;
+			cont_.for_each([&result](std::int64_t value) { result += value * 31 + 1; });
+			return result;
+		}
+	}
+
+private:
+	bool appended(std::int64_t ordinal) const { return ordinal >= 0 && ordinal < static_cast<std::int64_t>(handles_.size()); }
+
+	std::int64_t erase(std::int64_t ordinal)
+	{
+		if (!appended(ordinal) || cont_.find(handles_[ordinal]) == nullptr) return 0;
+		cont_.erase(handles_[ordinal]);
+		return 1;
+	}
+
+	std::int64_t find(std::int64_t ordinal)
+	{
+		const auto pValue = appended(ordinal) ? cont_.find(handles_[ordinal]) : nullptr;
+		return (pValue != nullptr) ? *pValue : trace_missing;
+	}
+
+	void compact()
+	{
+		if constexpr (impl::has_compaction<Registry>::value) {
+			cont_.start_compaction();
+			while (!cont_.compact(std::numeric_limits<std::size_t>::max())) {}
+		}
+	}
+
+private:
+	Registry cont_;
+	std::vector<handle_type> handles_;
+};
+
+class std_unordered_map_subject {
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		switch (entry.op) {
+		case trace_op::insert: cont_.emplace(appendedCount_, entry.value); return appendedCount_++;
+		case trace_op::erase: return static_cast<std::int64_t>(cont_.erase(entry.key));
+		case trace_op::find: return find(entry.key);
+		case trace_op::range: return static_cast<std::int64_t>(cont_.size());
+		case trace_op::clear: return static_cast<std::int64_t>(cont_.size());
+		case trace_op::insert_range: {
+			for (const auto key : range_keys(entry)) {
+				cont_.emplace(appendedCount_++, range_value(key));
+			}
+			return appendedCount_;
+		}
+		case trace_op::erase_range: {
+			std::int64_t count = 0;
+			for (const auto key : range_keys(entry)) {
+				count += static_cast<std::int64_t>(cont_.erase(key));
+			}
+			return count;
+		}
+		case trace_op::find_batch: {
+			std::int64_t result = 0;
+			for (const auto key : batch_keys(entry)) {
+				result = batch_step(result, find(key), 0);
+			}
+			return result;
+		}
+		}
+		return trace_missing;
+	}
+
+	std::int64_t digest()
+	{
+		std::int64_t result = 0;
+		for (const auto& keyValue : cont_) {
+			result += keyValue.second * 31 + 1;
+		}
+		return result;
+	}
+
+private:
+	std::int64_t find(std::int64_t key) const
+	{
+		const auto it = cont_.find(key);
+		return (it != cont_.end()) ? it->second : trace_missing;
+	}
+
+private:
+	std::unordered_map<std::int64_t, std::int64_t> cont_;
+	std::int64_t appendedCount_ = 0;
+};
+
+
+// wraps subject and records every applied operation
+template<class Subject>
+class trace_recorder {
+public:
+	std::int64_t apply(const trace_entry& entry)
+	{
+		trace_.record(entry.op, entry.key, entry.value);
+		return subject_.apply(entry);
+	}
+
+	Subject& subject() { return subject_; }
+	const workload_trace& trace() const { return trace_; }
+
+private:
+	Subject subject_;
+	workload_trace trace_;
+};
+
+
+// position of the first entry with different results of subject and oracle, trace.size() if there is no such entry;
+// digests are compared every checkInterval entries and at the end
+template<class Subject, class Oracle>
+std::size_t find_divergence(const workload_trace& trace, Subject& subject, Oracle& oracle, std::size_t checkInterval = 1024)
+{
+	const auto& entries = trace.entries();
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		if (subject.apply(entries[i]) != oracle.apply(entries[i])) {
+			return i;
+		}
+		if ((i + 1) % checkInterval == 0 && subject.digest() != oracle.digest()) {
+			return i;
+		}
+	}
+	return (entries.empty() || subject.digest() == oracle.digest()) ? entries.size() : entries.size() - 1;
+}
+
+// time of applying all entries of trace to subject
+template<class Subject>
+auto time_replay(const workload_trace& trace, Subject& subject) -> std::chrono::nanoseconds
+{
+	std::int64_t sink = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto& entry : trace.entries()) {
+		sink += subject.apply(entry);
+	}
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	volatile std::int64_t result = sink;
+	static_cast<void>(result);
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+}
+
+#endif // !WORKLOAD_TRACE_HPP